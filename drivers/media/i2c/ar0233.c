@@ -26,6 +26,24 @@
 #define AR0233_PM_RETRY_TIMEOUT		10
 #define AR0233_REG_SLEEP_200MS		200	/* 200ms */
 
+#define AR0233_REG_CHIP_ID		0x3000
+#define AR0233_CHIP_ID			0x0956
+
+#define AR0233_REG_RESET		0x301A
+#define AR0233_RESET_STREAM		BIT(2)
+
+#define AR0233_REG_VTS			0x300A
+#define AR0233_REG_HTS			0x300C
+#define AR0233_REG_EXPOSURE		0x3012
+#define AR0233_REG_X_OUTPUT_SIZE	0x034C
+#define AR0233_REG_Y_OUTPUT_SIZE	0x034E
+
+#define AR0233_VTS_MAX			0xFFFF
+
+#define AR0233_EXPOSURE_MIN		1
+#define AR0233_EXPOSURE_MAX_MARGIN	16
+#define AR0233_EXPOSURE_STEP		1
+
 struct ar0233_reg {
         enum {
                 AR0233_REG_LEN_DELAY = 0,
@@ -61,6 +79,12 @@ struct ar0233_mode {
 struct ar0233 {
         struct v4l2_subdev sd;
         struct media_pad pad;
+        struct v4l2_ctrl_handler ctrls;
+
+        /* V4L2 Controls */
+        struct v4l2_ctrl *exposure;
+        struct v4l2_ctrl *vblank;
+        struct v4l2_ctrl *pixel_rate;
 
         /* Current mode */
         const struct ar0233_mode *cur_mode;
@@ -79,6 +103,16 @@ struct ar0233 {
 
         /* Streaming on/off */
         bool streaming;
+
+        /* Sensor registers reachable, not hidden behind a module ISP */
+        bool reg_ctrl;
+
+        /* Sensor output and frame timing, read back when reg_ctrl is set */
+        u16 sensor_width;
+        u16 sensor_height;
+        u16 hts;
+        u16 vts_def;
+        u16 exposure_def;
 };
 
 static const struct ar0233_reg ar0233_3840_2160_30fps_reg[] = {
@@ -103,13 +137,230 @@ static const struct ar0233_mode supported_modes[] = {
 	},
 };
 
+static int ar0233_read_reg(struct i2c_client *client, u16 reg, u16 *val)
+{
+        struct i2c_msg msgs[2];
+        u8 addr_buf[2];
+        u8 data_buf[2];
+        int ret;
+
+        put_unaligned_be16(reg, addr_buf);
+
+        msgs[0].addr = client->addr;
+        msgs[0].flags = 0;
+        msgs[0].len = sizeof(addr_buf);
+        msgs[0].buf = addr_buf;
+
+        msgs[1].addr = client->addr;
+        msgs[1].flags = I2C_M_RD;
+        msgs[1].len = sizeof(data_buf);
+        msgs[1].buf = data_buf;
+
+        ret = i2c_transfer(client->adapter, msgs, ARRAY_SIZE(msgs));
+        if (ret != ARRAY_SIZE(msgs))
+                return -EIO;
+
+        *val = get_unaligned_be16(data_buf);
+
+        return 0;
+}
+
+static int ar0233_write_reg(struct i2c_client *client, u16 reg, u16 val)
+{
+        u8 buf[4];
+        int ret;
+
+        put_unaligned_be16(reg, buf);
+        put_unaligned_be16(val, buf + 2);
+
+        ret = i2c_master_send(client, buf, sizeof(buf));
+        if (ret != sizeof(buf))
+                return -EIO;
+
+        return 0;
+}
+
+static int ar0233_update_bits(struct i2c_client *client, u16 reg, u16 mask,
+                             u16 val)
+{
+        u16 cur;
+        int ret;
+
+        ret = ar0233_read_reg(client, reg, &cur);
+        if (ret)
+                return ret;
+
+        return ar0233_write_reg(client, reg, (cur & ~mask) | (val & mask));
+}
+
 static int ar0233_identify_module(struct ar0233 *ar0233)
 {
-        
         struct i2c_client *client = ar0233->client;
+        u16 chip_id;
+        int ret;
 
 	dev_dbg(&client->dev, "%s: Enter", __func__);
 
+        /*
+         * On the default GMSL modules an ISP answers on this address and
+         * drives the sensor. The 3840x2160 UYVY mode is the ISP output; the
+         * AR0233 itself is a ~2.6 MP raw sensor. The sensor registers are
+         * not reachable there: the ISP firmware sets frame rate and
+         * exposure, streaming is only gated by the serializer, and no
+         * controls are registered.
+         */
+        ret = ar0233_read_reg(client, AR0233_REG_CHIP_ID, &chip_id);
+        if (ret || chip_id != AR0233_CHIP_ID) {
+                dev_info(&client->dev,
+                         "module ISP owns the sensor, no stream or timing control\n");
+                return 0;
+        }
+
+        /*
+         * There is no sensor register list in this driver, so the frame
+         * timing is whatever the sensor is programmed with. Read it back
+         * instead of assuming one.
+         */
+        ret = ar0233_read_reg(client, AR0233_REG_X_OUTPUT_SIZE,
+                              &ar0233->sensor_width);
+        if (!ret)
+                ret = ar0233_read_reg(client, AR0233_REG_Y_OUTPUT_SIZE,
+                              &ar0233->sensor_height);
+        if (!ret)
+                ret = ar0233_read_reg(client, AR0233_REG_HTS, &ar0233->hts);
+        if (!ret)
+                ret = ar0233_read_reg(client, AR0233_REG_VTS, &ar0233->vts_def);
+        if (!ret)
+                ret = ar0233_read_reg(client, AR0233_REG_EXPOSURE,
+                              &ar0233->exposure_def);
+        if (ret)
+                return ret;
+
+        dev_dbg(&client->dev,
+                "output %ux%u, line length %u, frame length %u, exposure %u\n",
+                ar0233->sensor_width, ar0233->sensor_height, ar0233->hts,
+                ar0233->vts_def, ar0233->exposure_def);
+
+        ar0233->reg_ctrl = true;
+
+        return 0;
+}
+
+static int ar0233_set_ctrl(struct v4l2_ctrl *ctrl)
+{
+        struct ar0233 *ar0233 = container_of(ctrl->handler, struct ar0233, ctrls);
+        struct i2c_client *client = ar0233->client;
+        s64 exposure_max, exposure_def;
+        int ret;
+
+        /* Propagate change of current control to all related controls */
+        if (ctrl->id == V4L2_CID_VBLANK) {
+                /* Update max exposure while meeting expected vblanking */
+                exposure_max = ar0233->sensor_height + ctrl->val -
+                               AR0233_EXPOSURE_MAX_MARGIN;
+                exposure_def = min_t(s64, ar0233->exposure->val, exposure_max);
+                ret = __v4l2_ctrl_modify_range(ar0233->exposure,
+                                               ar0233->exposure->minimum,
+                                               exposure_max,
+                                               ar0233->exposure->step,
+                                               exposure_def);
+                if (ret) {
+                        dev_err(&client->dev, "Exposure ctrl range update failed");
+                        return ret;
+                }
+        }
+
+        /* V4L2 controls values will be applied only when power is already up */
+        if (!pm_runtime_get_if_in_use(&client->dev))
+                return 0;
+
+        switch (ctrl->id) {
+        case V4L2_CID_EXPOSURE:
+                ret = ar0233_write_reg(client, AR0233_REG_EXPOSURE, ctrl->val);
+                break;
+
+        case V4L2_CID_VBLANK:
+                ret = ar0233_write_reg(client, AR0233_REG_VTS,
+                                     ar0233->sensor_height + ctrl->val);
+                break;
+
+        default:
+                ret = -EINVAL;
+                break;
+        }
+
+        pm_runtime_put(&client->dev);
+
+        return ret;
+}
+
+static const struct v4l2_ctrl_ops ar0233_ctrl_ops = {
+        .s_ctrl = ar0233_set_ctrl,
+};
+
+static int ar0233_init_controls(struct ar0233 *ar0233)
+{
+        const struct ar0233_mode *mode = ar0233->cur_mode;
+        struct v4l2_ctrl_handler *hdl = &ar0233->ctrls;
+        s64 exposure_max, exposure_def, vblank_max, vblank_def, hblank;
+        s64 pixel_rate;
+        struct v4l2_ctrl *ctrl;
+
+        v4l2_ctrl_handler_init(hdl, 4);
+        hdl->lock = &ar0233->mutex;
+
+        /*
+         * The pixel clock follows from the module EXTCLK and the PLL setup,
+         * neither of which this driver knows. Derive it from the frame
+         * timing the mode runs at instead: the programmed line and frame
+         * length with register control, the active frame otherwise, as the
+         * module ISP blanking is not known either.
+         */
+        if (ar0233->reg_ctrl)
+                pixel_rate = (s64)ar0233->hts * ar0233->vts_def * mode->fps;
+        else
+                pixel_rate = (s64)mode->width * mode->height * mode->fps;
+
+        ar0233->pixel_rate = v4l2_ctrl_new_std(hdl, &ar0233_ctrl_ops,
+                                              V4L2_CID_PIXEL_RATE, pixel_rate,
+                                              pixel_rate, 1, pixel_rate);
+        if (ar0233->pixel_rate)
+                ar0233->pixel_rate->flags |= V4L2_CTRL_FLAG_READ_ONLY;
+
+        /* Frame timing is owned by the module ISP without register control */
+        if (!ar0233->reg_ctrl)
+                goto out;
+
+        hblank = ar0233->hts - ar0233->sensor_width;
+        ctrl = v4l2_ctrl_new_std(hdl, &ar0233_ctrl_ops, V4L2_CID_HBLANK,
+                                 hblank, hblank, 1, hblank);
+        if (ctrl)
+                ctrl->flags |= V4L2_CTRL_FLAG_READ_ONLY;
+
+        vblank_max = AR0233_VTS_MAX - ar0233->sensor_height;
+        vblank_def = ar0233->vts_def - ar0233->sensor_height;
+        ar0233->vblank = v4l2_ctrl_new_std(hdl, &ar0233_ctrl_ops,
+                                          V4L2_CID_VBLANK, 0, vblank_max, 1,
+                                          vblank_def);
+
+        /* Keep the exposure the sensor was programmed with as the default */
+        exposure_max = ar0233->vts_def - AR0233_EXPOSURE_MAX_MARGIN;
+        exposure_def = clamp_t(s64, ar0233->exposure_def, AR0233_EXPOSURE_MIN,
+                               exposure_max);
+        ar0233->exposure = v4l2_ctrl_new_std(hdl, &ar0233_ctrl_ops,
+                                            V4L2_CID_EXPOSURE,
+                                            AR0233_EXPOSURE_MIN, exposure_max,
+                                            AR0233_EXPOSURE_STEP,
+                                            exposure_def);
+
+out:
+        if (hdl->error) {
+                v4l2_ctrl_handler_free(hdl);
+                return hdl->error;
+        }
+
+        ar0233->sd.ctrl_handler = hdl;
+
         return 0;
 }
 
@@ -125,19 +376,43 @@ static void ar0233_update_pad_format(const struct ar0233_mode *mode,
 static int ar0233_start_streaming(struct ar0233 *ar0233)
 {
         struct i2c_client *client = ar0233->client;
+        int ret;
 
         dev_dbg(&client->dev, "%s: Enter", __func__);
 
-        return 0;
+        if (!ar0233->reg_ctrl)
+                return 0;
+
+        /* Applies VBLANK and exposure */
+        ret = __v4l2_ctrl_handler_setup(&ar0233->ctrls);
+        if (ret) {
+                dev_err(&client->dev, "failed to setup controls: %d\n", ret);
+                return ret;
+        }
+
+        ret = ar0233_update_bits(client, AR0233_REG_RESET, AR0233_RESET_STREAM,
+                                AR0233_RESET_STREAM);
+        if (ret)
+                dev_err(&client->dev, "failed to start streaming: %d\n", ret);
+
+        return ret;
 }
 
 static int ar0233_stop_streaming(struct ar0233 *ar0233)
 {
         struct i2c_client *client = ar0233->client;
+        int ret;
 
         dev_dbg(&client->dev, "%s: Enter", __func__);
 
-	return 0;	
+        if (!ar0233->reg_ctrl)
+                return 0;
+
+        ret = ar0233_update_bits(client, AR0233_REG_RESET, AR0233_RESET_STREAM, 0);
+        if (ret)
+                dev_err(&client->dev, "failed to stop streaming: %d\n", ret);
+
+	return ret;
 }
 
 static int ar0233_set_stream(struct v4l2_subdev *subdev, int enable)
@@ -162,8 +437,9 @@ static int ar0233_set_stream(struct v4l2_subdev *subdev, int enable)
 
 		ret = ar0233_start_streaming(ar0233);
 		if (ret) {
+			/* Best effort cleanup, report the start failure */
 			enable = 0;
-			ret = ar0233_stop_streaming(ar0233);
+			ar0233_stop_streaming(ar0233);
 			pm_runtime_put(&client->dev);
 		}
 	} else {
@@ -480,6 +756,7 @@ static void ar0233_remove(struct i2c_client *client)
 
         v4l2_async_unregister_subdev(sd);
         media_entity_cleanup(&sd->entity);
+        v4l2_ctrl_handler_free(&ar0233->ctrls);
         mutex_destroy(&ar0233->mutex);
         pm_runtime_disable(&client->dev);
 
@@ -554,20 +831,26 @@ static int ar0233_probe(struct i2c_client *client)
                 return ret;
         }
 
+        mutex_init(&ar0233->mutex);
+
         ret = ar0233_identify_module(ar0233);
         if (ret) {
                 dev_err(&client->dev, "failed to find sensor: %d", ret);
-                return ret;
+                goto probe_error_media_entity_cleanup;
         }
 
         if (ar0233->platform_data && ar0233->platform_data->suffix)
                 snprintf(ar0233->sd.name, sizeof(ar0233->sd.name), "ar0233 %s",
                          ar0233->platform_data->suffix);
 
-        mutex_init(&ar0233->mutex);
-
         ar0233->pre_mode = &supported_modes[0];
         ar0233->cur_mode = ar0233->pre_mode;
+
+        ret = ar0233_init_controls(ar0233);
+        if (ret) {
+                dev_err(&client->dev, "failed to init controls: %d", ret);
+                goto probe_error_media_entity_cleanup;
+        }
 #if LINUX_VERSION_CODE < KERNEL_VERSION(5, 13, 0)
         ret = v4l2_async_register_subdev_sensor_common(&ar0233->sd);
 #else
@@ -593,6 +876,7 @@ static int ar0233_probe(struct i2c_client *client)
 
 probe_error_media_entity_cleanup:
         media_entity_cleanup(&ar0233->sd.entity);
+        v4l2_ctrl_handler_free(&ar0233->ctrls);
         mutex_destroy(&ar0233->mutex);
 		
 	return ret;
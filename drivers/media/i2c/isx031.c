@@ -6,8 +6,10 @@
 #include <linux/gpio.h>
 #include <linux/i2c.h>
 #include <linux/interrupt.h>
+#include <linux/ktime.h>
 #include <linux/module.h>
 #include <linux/pm_runtime.h>
+#include <linux/suspend.h>
 #include <linux/version.h>
 #if LINUX_VERSION_CODE < KERNEL_VERSION(6, 12, 0)
 #include <asm/unaligned.h>
@@ -29,12 +31,15 @@
 #define ISX031_OTP_TYPE_NAME_H		0x7E8B
 #define ISX031_OTP_TYPE_NAME_H_FIELD	0x0F
 #define ISX031_OTP_MODULE_ID_L		0x031
+#define ISX031_OTP_TYPE_NAME_LEN	2
+
 
 #define ISX031_REG_MODE_SET_F		0x8A01
 #define ISX031_MODE_STANDBY		0x00
 #define ISX031_MODE_STREAMING		0x80
 
 #define ISX031_REG_SENSOR_STATE		0x6005
+#define ISX031_STATE_ANY		0x00
 #define ISX031_STATE_STREAMING		0x05
 #define ISX031_STATE_STARTUP		0x02
 
@@ -52,6 +57,10 @@
 #define ISX031_REG_SLEEP_10000US	10000	/* 10ms */
 #define ISX031_REG_SLEEP_20MS		20	/* 20ms */
 #define ISX031_REG_SLEEP_200MS		200	/* 200ms */
+#define ISX031_GPIO_POLL_US		1000	/* 1ms */
+#define ISX031_STATE_POLL_US		20000	/* 20ms */
+#define ISX031_READY_TIMEOUT_US		1000000	/* 1s */
+#define ISX031_TRANSIT_TIMEOUT_US	500000	/* 500ms */
 
 /* To serialize asynchronous callbacks */
 static DEFINE_MUTEX(isx031_mutex);
@@ -116,7 +125,16 @@ struct isx031 {
 	const struct isx031_mode *pre_mode;	/* Previous mode */
 
 	u8 lanes;
+	u32 fps;	/* Frame rate selecting the drive mode */
 	bool streaming;	/* Streaming on/off */
+	bool initialized;	/* Init/framesync lists applied since reset */
+	bool power_kept;	/* Sensor known powered across the last sleep */
+	bool identified;	/* Module ID verified since probe or reset */
+
+	/* Sensor state cached since the last reset */
+	int drive_mode;		/* Programmed drive mode, -1 if unknown */
+	bool mode_unlocked;	/* MODE_SET_F lock released */
+	u32 state;		/* Last confirmed state, 0 if unknown */
 };
 
 static const s64 isx031_link_frequencies[] = {
@@ -316,13 +334,14 @@ static int isx031_read_reg_state(struct i2c_client *client, u32 *val)
 	return ret;
 }
 
-static int isx031_read_reg_otp(struct i2c_client *client, u16 reg, u32 *val)
+static int isx031_read_reg_otp(struct i2c_client *client, u16 reg, u16 len,
+			       u32 *val)
 {
 	int ret;
 	int i;
 
 	for (i = 0; i < ISX031_READ_REG_RETRY_TIMEOUT; i++) {
-		ret = isx031_read_reg(client, reg, ISX031_REG_LEN_08BIT, val);
+		ret = isx031_read_reg(client, reg, len, val);
 		if (!ret)
 			return 0;
 
@@ -333,6 +352,40 @@ static int isx031_read_reg_otp(struct i2c_client *client, u16 reg, u32 *val)
 	return ret;
 }
 
+/*
+ * Poll the sensor state until the sensor reports the requested state, or any
+ * valid state for ISX031_STATE_ANY, rather than sleeping for the worst case
+ * boot or transition time. Every read is a remote I2C transaction through the
+ * serdes link, so poll coarsely and give up after a bounded number of reads.
+ */
+static int isx031_wait_for_state(struct i2c_client *client, u32 want,
+				 unsigned int timeout_us, u32 *state)
+{
+	unsigned int reads = DIV_ROUND_UP(timeout_us, ISX031_STATE_POLL_US) + 1;
+	u32 val = 0;
+	int ret;
+
+	for (;;) {
+		ret = isx031_read_reg(client, ISX031_REG_SENSOR_STATE,
+				      ISX031_REG_LEN_08BIT, &val);
+		if (!ret && (want == ISX031_STATE_ANY ?
+			     (val == ISX031_STATE_STARTUP ||
+			      val == ISX031_STATE_STREAMING) : val == want))
+			break;
+
+		if (!--reads)
+			return ret ? ret : -ETIMEDOUT;
+
+		usleep_range(ISX031_STATE_POLL_US,
+			     ISX031_STATE_POLL_US + 1000);
+	}
+
+	if (state)
+		*state = val;
+
+	return 0;
+}
+
 static int isx031_write_reg(struct i2c_client *client, u16 reg, u16 len, u32 val)
 {
 	u8 buf[6];
@@ -415,28 +468,62 @@ static int isx031_find_drive_mode(int lanes, int fps)
 	return -EINVAL;
 }
 
+/* Pick the supported frame rate closest to fps for the current lanes */
+static u32 isx031_closest_fps(struct isx031 *isx031, u32 fps)
+{
+	u32 best = 0;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(isx031_drive_modes); i++) {
+		if (isx031_drive_modes[i].lanes != isx031->lanes)
+			continue;
+
+		if (!best || abs((int)isx031_drive_modes[i].fps - (int)fps) <
+			     abs((int)best - (int)fps))
+			best = isx031_drive_modes[i].fps;
+	}
+
+	return best;
+}
+
 static int isx031_set_drive_mode(struct isx031 *isx031)
 {
 	struct i2c_client *client = isx031->client;
 	int mode, ret;
 
-	mode = isx031_find_drive_mode(isx031->lanes, isx031->cur_mode->fps);
+	mode = isx031_find_drive_mode(isx031->lanes, isx031->fps);
 	if (mode < 0) {
 		dev_err(&client->dev, "Failed to find drive mode\n");
 		return mode;
 	}
 
+	if (isx031->drive_mode == mode)
+		return 0;
+
 	ret = isx031_write_reg(client, ISX031_REG_MODE_SELECT, 1, mode);
+	if (ret)
+		return ret;
 
-	return ret;
+	isx031->drive_mode = mode;
+
+	return 0;
+}
+
+/* Forget cached sensor state, e.g. after the sensor was reset */
+static void isx031_invalidate_state(struct isx031 *isx031)
+{
+	isx031->initialized = false;
+	isx031->pre_mode = NULL;
+	isx031->drive_mode = -1;
+	isx031->mode_unlocked = false;
+	isx031->state = 0;
 }
 
 static int isx031_mode_transit(struct isx031 *isx031, int state)
 {
 	struct i2c_client *client = isx031->client;
 	int ret;
-	int cur_mode, mode = ISX031_MODE_STANDBY;
-	u32 val = 0;
+	int mode = ISX031_MODE_STANDBY;
 
 	if (state == ISX031_STATE_STARTUP)
 		mode = ISX031_MODE_STANDBY;
@@ -445,42 +532,68 @@ static int isx031_mode_transit(struct isx031 *isx031, int state)
 	else
 		return -EINVAL;
 
-	ret = isx031_read_reg_state(client, &val);
-	if (ret) {
-		dev_err(&client->dev, "Failed to read sensor state\n");
-		return ret;
-	}
-	cur_mode = val;
+	if (isx031->state == state)
+		return 0;
 
-	ret = isx031_set_drive_mode(isx031);
-	if (ret) {
-		dev_err(&client->dev, "Failed to set drive mode\n");
-		return ret;
+	/* MODE_SELECT only takes effect from standby, program it there */
+	if (state == ISX031_STATE_STREAMING) {
+		ret = isx031_set_drive_mode(isx031);
+		if (ret) {
+			dev_err(&client->dev, "Failed to set drive mode\n");
+			return ret;
+		}
 	}
 
-	ret = isx031_write_reg(client, ISX031_REG_MODE_SET_F_LOCK, 1,
-			       ISX031_MODE_UNLOCK);
-	if (ret) {
-		dev_err(&client->dev, "Failed to unlock mode\n");
-		return ret;
+	/* The lock stays released until the sensor is reset */
+	if (!isx031->mode_unlocked) {
+		ret = isx031_write_reg(client, ISX031_REG_MODE_SET_F_LOCK, 1,
+				       ISX031_MODE_UNLOCK);
+		if (ret) {
+			dev_err(&client->dev, "Failed to unlock mode\n");
+			return ret;
+		}
+		isx031->mode_unlocked = true;
 	}
 
+	/* Sensor state is unknown until the transition is confirmed */
+	isx031->state = 0;
+
 	ret = isx031_write_reg(client, ISX031_REG_MODE_SET_F, 1, mode);
 	if (ret) {
-		dev_err(&client->dev, "Failed to transit mode from 0x%x to 0x%x\n",
-			cur_mode, mode);
+		dev_err(&client->dev, "Failed to transit mode to 0x%x\n", mode);
 		return ret;
 	}
 
-	ret = isx031_read_reg_state(client, &val);
+	ret = isx031_wait_for_state(client, state, ISX031_TRANSIT_TIMEOUT_US,
+				    NULL);
 	if (ret) {
-		dev_err(&client->dev, "Failed to read sensor state\n");
+		dev_err(&client->dev, "Failed to reach sensor state 0x%x: %d\n",
+			state, ret);
 		return ret;
 	}
 
+	isx031->state = state;
+
 	return 0;
 }
 
+/*
+ * No drive mode switch is seamless: MODE_SELECT is only latched in standby.
+ * Switching while streaming cycles the sensor alone through standby with the
+ * new drive mode. Power, the mode register list and the downstream pipeline
+ * stay untouched, downstream only sees a gap of a few frames.
+ */
+static int isx031_switch_drive_mode(struct isx031 *isx031)
+{
+	int ret;
+
+	ret = isx031_mode_transit(isx031, ISX031_STATE_STARTUP);
+	if (ret)
+		return ret;
+
+	return isx031_mode_transit(isx031, ISX031_STATE_STREAMING);
+}
+
 static int isx031_initialize_module(struct isx031 *isx031)
 {
 	struct i2c_client *client = isx031->client;
@@ -493,6 +606,7 @@ static int isx031_initialize_module(struct isx031 *isx031)
 		dev_err(&client->dev, "Failed to read sensor state\n");
 		return ret;
 	}
+	isx031->state = val;
 
 	/* If sensor is streaming, transition to startup before initialization */
 	if (val == ISX031_STATE_STREAMING) {
@@ -514,29 +628,44 @@ static int isx031_initialize_module(struct isx031 *isx031)
 		}
 	}
 
+	isx031->initialized = true;
+
 	return 0;
 }
 
-static int isx031_identify_module(struct i2c_client *client)
+/*
+ * The init and framesync lists survive a sleep only when the sensor was
+ * neither reset nor powered down. The register contents cannot tell, so
+ * rely on what the driver knows about the last sleep instead.
+ */
+static bool isx031_init_applied(struct isx031 *isx031)
+{
+	return isx031->initialized && isx031->power_kept;
+}
+
+/*
+ * The OTP module ID cannot change while the sensor is neither reprobed nor
+ * power cycled through its reset GPIO, so it is checked once in between.
+ */
+static int isx031_identify_module(struct isx031 *isx031)
 {
-	u32 name_l = 0;
-	u32 name_h = 0;
+	struct i2c_client *client = isx031->client;
+	u32 name = 0;
 	u16 module_id;
 	int ret;
 
-	ret = isx031_read_reg_otp(client, ISX031_OTP_TYPE_NAME_L, &name_l);
-	if (ret) {
-		dev_err(&client->dev, "Failed to read OTP NAME_L register\n");
-		return ret;
-	}
+	if (isx031->identified)
+		return 0;
 
-	ret = isx031_read_reg_otp(client, ISX031_OTP_TYPE_NAME_H, &name_h);
+	/* NAME_L and NAME_H are adjacent, read both in one burst */
+	ret = isx031_read_reg_otp(client, ISX031_OTP_TYPE_NAME_L,
+				  ISX031_OTP_TYPE_NAME_LEN, &name);
 	if (ret) {
-		dev_err(&client->dev, "Failed to read OTP NAME_H register\n");
+		dev_err(&client->dev, "Failed to read OTP TYPE_NAME registers\n");
 		return ret;
 	}
 
-	module_id = ((name_h & ISX031_OTP_TYPE_NAME_H_FIELD) << 8) | name_l;
+	module_id = ((name & ISX031_OTP_TYPE_NAME_H_FIELD) << 8) | (name >> 8);
 	if (module_id != ISX031_OTP_MODULE_ID_L) {
 		dev_err(&client->dev,
 			"Invalid module ID: expected 0x%04x, got 0x%04x\n",
@@ -544,6 +673,8 @@ static int isx031_identify_module(struct i2c_client *client)
 		return -ENODEV;
 	}
 
+	isx031->identified = true;
+
 	return 0;
 }
 
@@ -700,13 +831,53 @@ static int __maybe_unused isx031_suspend(struct device *dev)
 
 	mutex_unlock(&isx031_mutex);
 
+	/*
+	 * Suspend to idle leaves the platform powered, deeper sleep states may
+	 * cut the sensor supply behind the driver's back.
+	 */
+	isx031->power_kept = !pm_suspend_via_firmware();
+
 	/* Active low gpio reset, set 1 to power off sensor */
-	if (isx031->reset_gpio)
+	if (isx031->reset_gpio) {
 		gpiod_set_value_cansleep(isx031->reset_gpio, 1);
+		isx031_invalidate_state(isx031);
+		isx031->identified = false;
+	}
 
 	return 0;
 }
 
+static int __maybe_unused isx031_poweroff(struct device *dev)
+{
+	struct i2c_client *client = to_i2c_client(dev);
+	struct v4l2_subdev *sd = i2c_get_clientdata(client);
+	struct isx031 *isx031 = to_isx031(sd);
+	int ret;
+
+	ret = isx031_suspend(dev);
+
+	/* Hibernation powers the system off */
+	isx031->power_kept = false;
+
+	return ret;
+}
+
+/* Release an active low gpio and wait for the line to follow */
+static int isx031_release_gpio(struct gpio_desc *gpio)
+{
+	int count;
+
+	for (count = 0; count < ISX031_PM_RETRY_TIMEOUT; count++) {
+		gpiod_set_value_cansleep(gpio, 0);
+		if (gpiod_get_value_cansleep(gpio) == 0)
+			return 0;
+
+		usleep_range(ISX031_GPIO_POLL_US, ISX031_GPIO_POLL_US + 100);
+	}
+
+	return -ETIMEDOUT;
+}
+
 static int __maybe_unused isx031_resume(struct device *dev)
 {
 	struct i2c_client *client = to_i2c_client(dev);
@@ -714,7 +885,6 @@ static int __maybe_unused isx031_resume(struct device *dev)
 	struct isx031 *isx031 = to_isx031(sd);
 	const struct isx031_reg_list *reg_list;
 	int ret;
-	int count;
 
 	mutex_lock(&isx031_mutex);
 
@@ -722,19 +892,10 @@ static int __maybe_unused isx031_resume(struct device *dev)
 	 * sensor must be on before resume
 	 */
 	if (isx031->reset_gpio) {
-		for (count = 0; count < ISX031_PM_RETRY_TIMEOUT; count++) {
-			gpiod_set_value_cansleep(isx031->reset_gpio, 0);
-			msleep(ISX031_REG_SLEEP_200MS);
-
-			ret = gpiod_get_value_cansleep(isx031->reset_gpio);
-			if (ret == 0)
-				break;
-		}
-
-		if (ret != 0) {
+		ret = isx031_release_gpio(isx031->reset_gpio);
+		if (ret) {
 			dev_err(&client->dev, "Failed to power on sensor in pm resume\n");
-			mutex_unlock(&isx031_mutex);
-			return -ETIMEDOUT;
+			goto unlock;
 		}
 	}
 	/* S4 will clear the GPIO BIAS and CONFIG
@@ -743,39 +904,44 @@ static int __maybe_unused isx031_resume(struct device *dev)
 	if (isx031->fsin_gpio) {
 		gpiod_direction_output(isx031->fsin_gpio, 0);
 
-		for (count = 0; count < ISX031_PM_RETRY_TIMEOUT; count++) {
-			gpiod_set_value_cansleep(isx031->fsin_gpio, 0);
-			msleep(ISX031_REG_SLEEP_200MS);
-
-			ret = gpiod_get_value_cansleep(isx031->fsin_gpio);
-			if (ret == 0)
-				break;
-		}
-
-		if (ret != 0) {
+		ret = isx031_release_gpio(isx031->fsin_gpio);
+		if (ret) {
 			dev_err(&client->dev, "Failed to turn on fsin in pm resume\n");
-			mutex_unlock(&isx031_mutex);
-			return -ETIMEDOUT;
+			goto unlock;
 		}
 	}
 
-	ret = isx031_identify_module(client);
+	ret = isx031_wait_for_state(client, ISX031_STATE_ANY,
+				    ISX031_READY_TIMEOUT_US, NULL);
 	if (ret) {
-		dev_err(&client->dev, "Failed to identify sensor module: %d\n", ret);
+		dev_err(&client->dev, "Sensor not ready in pm resume: %d\n", ret);
 		goto unlock;
 	}
 
-	ret = isx031_initialize_module(isx031);
+	ret = isx031_identify_module(isx031);
 	if (ret) {
-		dev_err(&client->dev, "Failed to initialize sensor module: %d\n", ret);
+		dev_err(&client->dev, "Failed to identify sensor module: %d\n", ret);
 		goto unlock;
 	}
 
-	reg_list = &isx031->cur_mode->reg_list;
-	ret = isx031_write_reg_list(client, reg_list, true);
-	if (ret) {
-		dev_err(&client->dev, "Failed to apply cur mode in resume: %d\n", ret);
-		goto unlock;
+	if (!isx031_init_applied(isx031)) {
+		isx031_invalidate_state(isx031);
+
+		ret = isx031_initialize_module(isx031);
+		if (ret) {
+			dev_err(&client->dev, "Failed to initialize sensor module: %d\n", ret);
+			goto unlock;
+		}
+	}
+
+	if (isx031->cur_mode != isx031->pre_mode) {
+		reg_list = &isx031->cur_mode->reg_list;
+		ret = isx031_write_reg_list(client, reg_list, true);
+		if (ret) {
+			dev_err(&client->dev, "Failed to apply cur mode in resume: %d\n", ret);
+			goto unlock;
+		}
+		isx031->pre_mode = isx031->cur_mode;
 	}
 
 	if (isx031->streaming) {
@@ -830,6 +996,124 @@ static int isx031_get_frame_desc(struct v4l2_subdev *sd,
 }
 #endif
 
+/*
+ * Lists every drive mode rate of the configured lane count. All of them can
+ * be set while streaming, none seamlessly, see isx031_switch_drive_mode().
+ */
+static int isx031_enum_frame_interval(struct v4l2_subdev *sd,
+#if LINUX_VERSION_CODE < KERNEL_VERSION(5, 14, 0)
+				     struct v4l2_subdev_pad_config *cfg,
+#else
+				     struct v4l2_subdev_state *sd_state,
+#endif
+				     struct v4l2_subdev_frame_interval_enum *fie)
+{
+	struct isx031 *isx031 = to_isx031(sd);
+	unsigned int index = 0;
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(supported_modes); i++) {
+		if (supported_modes[i].code == fie->code &&
+		    supported_modes[i].width == fie->width &&
+		    supported_modes[i].height == fie->height)
+			break;
+	}
+
+	if (i == ARRAY_SIZE(supported_modes))
+		return -EINVAL;
+
+	for (i = 0; i < ARRAY_SIZE(isx031_drive_modes); i++) {
+		if (isx031_drive_modes[i].lanes != isx031->lanes)
+			continue;
+
+		if (index++ == fie->index) {
+			fie->interval.numerator = 1;
+			fie->interval.denominator = isx031_drive_modes[i].fps;
+			return 0;
+		}
+	}
+
+	return -EINVAL;
+}
+
+static int isx031_get_frame_interval(struct v4l2_subdev *sd,
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 8, 0)
+				     struct v4l2_subdev_state *sd_state,
+#endif
+				     struct v4l2_subdev_frame_interval *fi)
+{
+	struct isx031 *isx031 = to_isx031(sd);
+
+	mutex_lock(&isx031_mutex);
+
+	fi->interval.numerator = 1;
+	fi->interval.denominator = isx031->fps;
+
+	mutex_unlock(&isx031_mutex);
+
+	return 0;
+}
+
+static int isx031_set_frame_interval(struct v4l2_subdev *sd,
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 8, 0)
+				     struct v4l2_subdev_state *sd_state,
+#endif
+				     struct v4l2_subdev_frame_interval *fi)
+{
+	struct isx031 *isx031 = to_isx031(sd);
+	struct i2c_client *client = isx031->client;
+	u32 fps, pre_fps;
+	int ret = 0;
+
+	if (!fi->interval.numerator || !fi->interval.denominator)
+		return -EINVAL;
+
+	mutex_lock(&isx031_mutex);
+
+	fps = isx031_closest_fps(isx031,
+				 DIV_ROUND_CLOSEST(fi->interval.denominator,
+						   fi->interval.numerator));
+	if (!fps) {
+		ret = -EINVAL;
+		goto unlock;
+	}
+
+	fi->interval.numerator = 1;
+	fi->interval.denominator = fps;
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 8, 0)
+	if (fi->which == V4L2_SUBDEV_FORMAT_TRY)
+		goto unlock;
+#endif
+
+	if (fps == isx031->fps)
+		goto unlock;
+
+	pre_fps = isx031->fps;
+	isx031->fps = fps;
+
+	if (isx031->streaming) {
+		ktime_t start = ktime_get();
+
+		ret = isx031_switch_drive_mode(isx031);
+		if (ret) {
+			dev_err(&client->dev, "Failed to switch to %u fps: %d\n",
+				fps, ret);
+			isx031->fps = pre_fps;
+			isx031_switch_drive_mode(isx031);
+			goto unlock;
+		}
+
+		dev_dbg(&client->dev, "Switched %u -> %u fps, %lld us in standby\n",
+			pre_fps, fps, ktime_us_delta(ktime_get(), start));
+	}
+
+unlock:
+	mutex_unlock(&isx031_mutex);
+
+	return ret;
+}
+
 static int isx031_set_format(struct v4l2_subdev *sd,
 #if LINUX_VERSION_CODE < KERNEL_VERSION(5, 14, 0)
 			     struct v4l2_subdev_pad_config *cfg,
@@ -928,11 +1212,20 @@ static int isx031_open(struct v4l2_subdev *sd, struct v4l2_subdev_fh *fh)
 
 static const struct v4l2_subdev_video_ops isx031_video_ops = {
 	.s_stream = isx031_set_stream,
+#if LINUX_VERSION_CODE < KERNEL_VERSION(6, 8, 0)
+	.g_frame_interval = isx031_get_frame_interval,
+	.s_frame_interval = isx031_set_frame_interval,
+#endif
 };
 
 static const struct v4l2_subdev_pad_ops isx031_pad_ops = {
 	.set_fmt = isx031_set_format,
 	.get_fmt = isx031_get_format,
+	.enum_frame_interval = isx031_enum_frame_interval,
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 8, 0)
+	.get_frame_interval = isx031_get_frame_interval,
+	.set_frame_interval = isx031_set_frame_interval,
+#endif
 	.get_frame_desc = isx031_get_frame_desc,
 	.enable_streams = isx031_enable_streams,
 	.disable_streams = isx031_disable_streams,
@@ -951,13 +1244,39 @@ static const struct v4l2_subdev_internal_ops isx031_internal_ops = {
 	.open = isx031_open,
 };
 
+/*
+ * The module ISP blanking is not known, so this is the active pixel rate of
+ * the current mode at the current frame rate.
+ */
+static s64 isx031_pixel_rate(struct isx031 *isx031)
+{
+	const struct isx031_mode *mode = isx031->cur_mode;
+
+	return (s64)mode->width * mode->height * isx031->fps;
+}
+
 static int isx031_set_ctrl(struct v4l2_ctrl *ctrl)
 {
 	return 0;
 };
 
+static int isx031_get_volatile_ctrl(struct v4l2_ctrl *ctrl)
+{
+	struct isx031 *isx031 = container_of(ctrl->handler, struct isx031,
+					     ctrls);
+
+	switch (ctrl->id) {
+	case V4L2_CID_PIXEL_RATE:
+		*ctrl->p_new.p_s64 = isx031_pixel_rate(isx031);
+		return 0;
+	default:
+		return -EINVAL;
+	}
+}
+
 static const struct v4l2_ctrl_ops isx031_ctrl_ops = {
 	.s_ctrl = isx031_set_ctrl,
+	.g_volatile_ctrl = isx031_get_volatile_ctrl,
 };
 
 static int isx031_ctrls_init(struct isx031 *sensor)
@@ -972,15 +1291,21 @@ static int isx031_ctrls_init(struct isx031 *sensor)
 				      V4L2_CID_LINK_FREQ,
 				      ARRAY_SIZE(isx031_link_frequencies) - 1, 0,
 				      isx031_link_frequencies);
+	if (ctrl)
+		ctrl->flags |= V4L2_CTRL_FLAG_READ_ONLY;
+
+	/* Follows the mode and frame rate, see isx031_get_volatile_ctrl() */
+	ctrl = v4l2_ctrl_new_std(hdl, &isx031_ctrl_ops, V4L2_CID_PIXEL_RATE,
+				 1, S64_MAX, 1, isx031_pixel_rate(sensor));
+	if (ctrl)
+		ctrl->flags |= V4L2_CTRL_FLAG_READ_ONLY |
+			       V4L2_CTRL_FLAG_VOLATILE;
 
 	if (hdl->error) {
 		v4l2_ctrl_handler_free(hdl);
 		return hdl->error;
 	}
 
-	if (ctrl)
-		ctrl->flags |= V4L2_CTRL_FLAG_READ_ONLY;
-
 	sensor->sd.ctrl_handler = hdl;
 
 	return 0;
@@ -1039,6 +1364,10 @@ static int isx031_probe(struct i2c_client *client)
 	sd = &isx031->sd;
 	v4l2_i2c_subdev_init(sd, client, &isx031_subdev_ops);
 
+	/* 1920x1536 default */
+	isx031->cur_mode = &supported_modes[0];
+	isx031->fps = isx031->cur_mode->fps;
+
 	ret = isx031_ctrls_init(isx031);
 	if (ret) {
 		dev_err(&client->dev, "Failed to init sensor ctrls: %d\n", ret);
@@ -1080,15 +1409,13 @@ static int isx031_probe(struct i2c_client *client)
 		}
 	}
 
-	ret = isx031_identify_module(client);
+	ret = isx031_identify_module(isx031);
 	if (ret) {
 		dev_err(&client->dev, "Failed to identify sensor module: %d\n", ret);
 		goto err_media_cleanup;
 	}
 
-	/* 1920x1536 default */
-	isx031->pre_mode = NULL;
-	isx031->cur_mode = &supported_modes[0];
+	isx031_invalidate_state(isx031);
 	ret = isx031_initialize_module(isx031);
 	if (ret) {
 		dev_err(&client->dev, "Failed to initialize sensor: %d\n", ret);
@@ -1133,6 +1460,9 @@ err_ctrl_free:
 
 static const struct dev_pm_ops isx031_pm_ops = {
 	SET_SYSTEM_SLEEP_PM_OPS(isx031_suspend, isx031_resume)
+#ifdef CONFIG_PM_SLEEP
+	.poweroff = isx031_poweroff,
+#endif
 };
 
 static const struct i2c_device_id isx031_id_table[] = {
@@ -65,6 +65,7 @@ static int max96724_enable_serial_link(struct max9x_common *common, unsigned int
 static int max96724_set_remote_control_channel_enabled(struct max9x_common *common, unsigned int link_id, bool enabled);
 static int max96724_select_serial_link(struct max9x_common *common, unsigned int link);
 static int max96724_deselect_serial_link(struct max9x_common *common, unsigned int link);
+static int max96724_select_serial_links(struct max9x_common *common, unsigned long mask);
 static int max96724_disable_line_fault(struct max9x_common *common, unsigned int line);
 static int max96724_enable_line_fault(struct max9x_common *common, unsigned int line);
 static int max96724_set_line_fault(struct max9x_common *common, unsigned int line, bool enable);
@@ -916,12 +917,32 @@ static int max96724_deselect_serial_link(struct max9x_common *common, unsigned i
 	return max96724_set_remote_control_channel_enabled(common, link, false);
 }
 
+static int max96724_select_serial_links(struct max9x_common *common, unsigned long mask)
+{
+	struct device *dev = common->dev;
+	struct regmap *map = common->map;
+	unsigned int val = ~0;
+	unsigned int link_id;
+	int ret;
+
+	for_each_set_bit(link_id, &mask, common->num_serial_links)
+		val &= ~MAX9X_FIELD_PREP(MAX96724_REM_CC_DIS_PORT_FIELD(link_id, 0), 1);
+
+	mutex_lock(&common->link_mutex);
+	dev_dbg(dev, "set rem cc enable 0x%lx", mask);
+	ret = regmap_write(map, MAX96724_REM_CC, val);
+	mutex_unlock(&common->link_mutex);
+
+	return ret;
+}
+
 static struct max9x_serial_link_ops max96724_serial_link_ops = {
 	.enable = max96724_enable_serial_link,
 	.disable = max96724_disable_serial_link,
 	.select = max96724_select_serial_link,
 	.deselect = max96724_deselect_serial_link,
 	.get_locked = max96724_get_serial_link_lock,
+	.select_links = max96724_select_serial_links,
 };
 
 static int max96724_disable_line_fault(struct max9x_common *common, unsigned int line)
@@ -22,6 +22,8 @@
 #include <linux/kernel.h>
 #include <linux/i2c.h>
 #include <linux/i2c-mux.h>
+#include <linux/interrupt.h>
+#include <linux/iopoll.h>
 #include <linux/gpio/consumer.h>
 #include <linux/gpio/machine.h>
 #include <linux/regulator/consumer.h>
@@ -29,12 +31,19 @@
 #include <linux/slab.h>
 #include <linux/pm.h>
 #include <linux/of_gpio.h>
+#include <linux/workqueue.h>
+#include <media/v4l2-event.h>
 
 #include "serdes.h"
 #include "regmap-retry.h"
 
 #include "media/ipu-acpi-pdata.h"
 
+// Params
+static int max9x_status_poll_ms = 1000;
+module_param(max9x_status_poll_ms, int, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+MODULE_PARM_DESC(max9x_status_poll_ms, "Link lock and line fault sampling period in milliseconds, 0 for ERRB only");
+
 static const s64 max9x_op_sys_clock[] =  {
 	MAX9X_LINK_FREQ_MBPS_TO_HZ(2500),
 	MAX9X_LINK_FREQ_MBPS_TO_HZ(2400),
@@ -152,6 +161,7 @@ static int max9x_setup_gpio(struct max9x_common *common);
 static int max9x_enable(struct max9x_common *common);
 static int max9x_disable(struct max9x_common *common);
 static int max9x_verify_devid(struct max9x_common *common);
+static int max9x_wait_ready(struct max9x_common *common, struct regmap *map, const char *event);
 
 static int max9x_enable_resume(struct max9x_common *common);
 static int max9x_remap_serializers_resume(struct max9x_common *common, unsigned int link_id);
@@ -169,8 +179,14 @@ static void max9x_sysfs_destroy_get_link(struct max9x_common *common, unsigned i
 
 static int max9x_enable_line_faults(struct max9x_common *common);
 static int max9x_disable_line_faults(struct max9x_common *common);
+static int max9x_sysfs_create_line_fault_status(struct max9x_common *common, unsigned int line);
 static void max9x_sysfs_destroy_line_fault_status(struct max9x_common *common, unsigned int line);
 
+static int max9x_status_init(struct max9x_common *common);
+static void max9x_status_start(struct max9x_common *common);
+static void max9x_status_stop(struct max9x_common *common);
+static void max9x_status_work(struct work_struct *work);
+
 static int max9x_parse_pdata(struct max9x_common *common, struct max9x_pdata *pdata);
 static int max9x_parse_serial_link_pdata(struct max9x_common *common,
 					 struct max9x_serial_link_pdata *max9x_serial_link_pdata);
@@ -184,8 +200,10 @@ static int max9x_deselect_i2c_chan(struct i2c_mux_core *muxc, u32 chan_id);
 
 static int max9x_des_isolate_serial_link(struct max9x_common *common, unsigned int link_id);
 static int max9x_des_deisolate_serial_link(struct max9x_common *common, unsigned int link_id);
+static void max9x_des_update_shared_links(struct max9x_common *common);
 
 static ssize_t max9x_link_status_show(struct device *dev, struct device_attribute *attr, char *buf);
+static ssize_t max9x_line_fault_status_show(struct device *dev, struct device_attribute *attr, char *buf);
 
 static int max9x_setup_translations(struct max9x_common *common);
 static int max9x_disable_translations(struct max9x_common *common);
@@ -656,8 +674,19 @@ int max9x_common_resume(struct max9x_common *common)
 		goto err_disable;
 	}
 
-	if (common->type == MAX9X_SERIALIZER && des_common)
+	ret = max9x_enable_line_faults(common);
+	if (ret) {
+		dev_err(dev, "Failed to enable line faults");
+		goto err_disable;
+	}
+
+	if (common->type == MAX9X_SERIALIZER && des_common) {
+		set_bit(des_link, &des_common->ready_links);
 		max9x_des_deisolate_serial_link(des_common, des_link);
+		max9x_des_update_shared_links(des_common);
+	}
+
+	max9x_status_start(common);
 
 	return 0;
 
@@ -686,6 +715,14 @@ int max9x_common_suspend(struct max9x_common *common)
 
 	dev_dbg(common->dev, "try to suspend");
 
+	max9x_status_stop(common);
+
+	/* Serializers come back at their physical address after resume. */
+	mutex_lock(&common->isolate_mutex);
+	common->shared_links = 0;
+	common->ready_links = 0;
+	mutex_unlock(&common->isolate_mutex);
+
 	for (link_id = 0; link_id < common->num_serial_links; link_id++)
 		max9x_disable_serial_link(common, link_id);
 
@@ -771,6 +808,8 @@ int max9x_common_init_i2c_client(struct max9x_common *common,
 	mutex_init(&common->isolate_mutex);
 	common->isolated_link = -1;
 	common->selected_link = -1;
+	INIT_DELAYED_WORK(&common->status_work, max9x_status_work);
+	common->errb_irq = -1;
 
 	ret = MAX9X_ALLOCATE_ELEMENTS(common, MAX9X_CSI_LINK, csi_link, num_csi_links);
 	if (ret)
@@ -855,10 +894,16 @@ enable_err:
 	if (ret)
 		goto err_enable;
 
+	ret = max9x_status_init(common);
+	if (ret)
+		goto err_adapters;
+
 	ret = max9x_register_v4l_subdev(common);
 	if (ret)
 		goto err_adapters;
 
+	max9x_status_start(common);
+
 	return 0;
 
 err_adapters:
@@ -878,6 +923,8 @@ void max9x_destroy(struct max9x_common *common)
 
 	dev_dbg(common->dev, "Destroy");
 
+	max9x_status_stop(common);
+
 	max9x_disable_translations(common);
 
 	for (link_id = 0; link_id < common->num_serial_links; link_id++) {
@@ -1021,15 +1068,21 @@ int max9x_enable(struct max9x_common *common)
 		}
 	}
 
-	dev_info(dev, "sleep for startup after soft reset");
-	usleep_range(100000, 100050);
+	/* After reset the device answers at its physical address */
+	ret = max9x_wait_ready(common, phys_addr != virt_addr ? common->phys_map : common->map,
+			       "reset");
+	if (ret)
+		goto err;
 
 	if (phys_addr != virt_addr) {
 		/* Device is now reset, but requires remap */
 		ret = max9x_remap_addr(common);
 		if (ret)
 			goto err;
-		msleep(20);
+
+		ret = max9x_wait_ready(common, common->map, "remap");
+		if (ret)
+			goto err;
 	}
 
 	if (common->common_ops && common->common_ops->enable) {
@@ -1138,6 +1191,32 @@ int max9x_verify_devid(struct max9x_common *common)
 	return 0;
 }
 
+/*
+ * max9x_wait_ready() - Polls the device ID at @map until the chip answers
+ *
+ * Replaces fixed startup sleeps, the time the chip actually took is logged.
+ */
+static int max9x_wait_ready(struct max9x_common *common, struct regmap *map, const char *event)
+{
+	struct device *dev = common->dev;
+	ktime_t start = ktime_get();
+	unsigned int dev_id;
+	int err;
+	int ret;
+
+	ret = read_poll_timeout(regmap_read, err, !err && dev_id == common->des->dev_id,
+				MAX9X_READY_POLL_US, MAX9X_READY_TIMEOUT_US, false,
+				map, MAX9X_DEV_ID, &dev_id);
+	if (ret) {
+		dev_err(dev, "Not ready %d us after %s", MAX9X_READY_TIMEOUT_US, event);
+		return ret;
+	}
+
+	dev_info(dev, "Ready %lld us after %s", ktime_us_delta(ktime_get(), start), event);
+
+	return 0;
+}
+
 /* TODO: remap not hardcode according to pdata */
 int max9x_remap_serializers(struct max9x_common *common, unsigned int link_id)
 {
@@ -1784,10 +1863,202 @@ static const struct v4l2_subdev_pad_ops max9x_sd_pad_ops = {
 	.disable_streams = max9x_disable_streams,
 };
 
+static int max9x_subscribe_event(struct v4l2_subdev *sd, struct v4l2_fh *fh,
+				 struct v4l2_event_subscription *sub)
+{
+	switch (sub->type) {
+	case MAX9X_EVENT_LINK_LOCK:
+	case MAX9X_EVENT_LINE_FAULT:
+		return v4l2_event_subscribe(fh, sub, MAX9X_EVENT_QUEUE_LEN, NULL);
+	default:
+		return v4l2_ctrl_subdev_subscribe_event(sd, fh, sub);
+	}
+}
+
+static const struct v4l2_subdev_core_ops max9x_sd_core_ops = {
+	.subscribe_event = max9x_subscribe_event,
+	.unsubscribe_event = v4l2_event_subdev_unsubscribe,
+};
+
 static struct v4l2_subdev_ops max9x_sd_ops = {
+	.core = &max9x_sd_core_ops,
 	.pad = &max9x_sd_pad_ops,
 };
 
+/*
+ * max9x_create_pad_link() - Creates an immutable link from @source to @sink_pad of @sd
+ *
+ * Serializers are registered concurrently, see max9x_des_register_serializers(), so the
+ * media graph is only changed under its graph mutex.
+ */
+static int max9x_create_pad_link(struct v4l2_subdev *sd, struct media_entity *source,
+				 u16 source_pad, u16 sink_pad)
+{
+	struct media_device *mdev = sd->v4l2_dev->mdev;
+	int ret;
+
+	if (mdev)
+		mutex_lock(&mdev->graph_mutex);
+
+	ret = media_create_pad_link(source, source_pad, &sd->entity, sink_pad,
+				    MEDIA_LNK_FL_IMMUTABLE | MEDIA_LNK_FL_ENABLED);
+
+	if (mdev)
+		mutex_unlock(&mdev->graph_mutex);
+
+	return ret;
+}
+
+/*
+ * max9x_des_new_serializer() - Probes the serializer of a link without registering its subdev
+ *
+ * Same as v4l2_i2c_new_subdev_board(), minus v4l2_device_register_subdev() which is left to
+ * max9x_des_register_serializers(). The serializer drivers live in this module, so there is
+ * no module to request or pin.
+ */
+static struct i2c_client *max9x_des_new_serializer(struct max9x_common *common, unsigned int link_id)
+{
+	struct max9x_subdev_pdata *subdev_pdata = common->serial_link[link_id].remote.pdata;
+	struct i2c_client *client;
+
+	client = i2c_new_client_device(common->muxc->adapter[link_id], &subdev_pdata->board_info);
+	if (IS_ERR(client))
+		return client;
+
+	if (!i2c_client_has_driver(client) || !i2c_get_clientdata(client)) {
+		i2c_unregister_device(client);
+		return ERR_PTR(-ENODEV);
+	}
+
+	return client;
+}
+
+/*
+ * max9x_des_remove_serializers() - Removes the serializers of all links, registered or not
+ */
+static void max9x_des_remove_serializers(struct max9x_common *common)
+{
+	for (unsigned int link_id = 0; link_id < common->num_serial_links; link_id++) {
+		struct max9x_serdes_serial_link *serial_link = &common->serial_link[link_id];
+
+		if (!serial_link->remote.client)
+			continue;
+
+		/* No-op for a serializer whose subdev isn't registered yet */
+		v4l2_device_unregister_subdev(i2c_get_clientdata(serial_link->remote.client));
+		i2c_unregister_device(serial_link->remote.client);
+		serial_link->remote.client = NULL;
+		clear_bit(link_id, &common->ready_links);
+	}
+}
+
+struct max9x_ser_registration {
+	struct work_struct work;
+	struct max9x_common *common;
+	unsigned int link_id;
+	int ret;
+};
+
+/*
+ * max9x_des_register_serializer() - Registers the subdev of a probed serializer
+ *
+ * Registering the serializer registers the sensors behind it, see max9x_registered(). This
+ * runs from a workqueue rather than an async domain: the sensors are created with
+ * v4l2_i2c_new_subdev_board(), which waits on request_module(), and module loading must
+ * not be waited for from an async worker.
+ */
+static void max9x_des_register_serializer(struct work_struct *work)
+{
+	struct max9x_ser_registration *reg =
+		container_of(work, struct max9x_ser_registration, work);
+	struct max9x_common *common = reg->common;
+	struct max9x_serdes_serial_link *serial_link = &common->serial_link[reg->link_id];
+	struct max9x_subdev_pdata *subdev_pdata = serial_link->remote.pdata;
+	struct device *dev = common->dev;
+	struct v4l2_subdev *sd = &common->v4l.sd;
+	struct v4l2_subdev *subdev = i2c_get_clientdata(serial_link->remote.client);
+	struct max9x_common *ser_common = max9x_sd_to_common(subdev);
+	int remote_pad, local_pad;
+	int ret;
+
+	ret = v4l2_device_register_subdev(sd->v4l2_dev, subdev);
+	if (ret) {
+		dev_err(dev, "Failure registering serializer %s (0x%02x)",
+			subdev_pdata->board_info.type,
+			subdev_pdata->board_info.addr);
+		i2c_unregister_device(serial_link->remote.client);
+		serial_link->remote.client = NULL;
+		clear_bit(reg->link_id, &common->ready_links);
+		reg->ret = ret;
+		return;
+	}
+
+	dev_dbg(dev, "Registered serializer %s (0x%02x)",
+		subdev_pdata->board_info.type,
+		subdev_pdata->board_info.addr);
+
+	remote_pad = max9x_serial_link_to_pad(ser_common, 0);
+	local_pad = max9x_serial_link_to_pad(common, reg->link_id);
+
+	dev_dbg(dev, "Create link from ser link 0 (pad %d) -> des link %d (pad %d)",
+		remote_pad, reg->link_id, local_pad);
+
+	ret = max9x_create_pad_link(sd, &subdev->entity, remote_pad, local_pad);
+	if (ret)
+		dev_err(dev, "Failed creating pad link to serializer");
+
+	reg->ret = ret;
+}
+
+/*
+ * max9x_des_register_serializers() - Registers all probed serializers in parallel
+ *
+ * The serializers were probed one link at a time, as they all start out at the same
+ * physical address. Once remapped, nothing on one link depends on another, so the
+ * serializers and their sensors are registered concurrently. The links are shared
+ * first when their addresses allow it, so sensor probes need no link selection.
+ */
+static int max9x_des_register_serializers(struct max9x_common *common)
+{
+	struct max9x_ser_registration *regs;
+	unsigned int link_id;
+	int ret = 0;
+
+	max9x_des_update_shared_links(common);
+
+	regs = kcalloc(common->num_serial_links, sizeof(*regs), GFP_KERNEL);
+	if (!regs)
+		return -ENOMEM;
+
+	for (link_id = 0; link_id < common->num_serial_links; link_id++) {
+		if (!common->serial_link[link_id].remote.client)
+			continue;
+
+		regs[link_id].common = common;
+		regs[link_id].link_id = link_id;
+		INIT_WORK(&regs[link_id].work, max9x_des_register_serializer);
+		queue_work(system_unbound_wq, &regs[link_id].work);
+	}
+
+	for (link_id = 0; link_id < common->num_serial_links; link_id++) {
+		if (!regs[link_id].common)
+			continue;
+
+		flush_work(&regs[link_id].work);
+
+		if (regs[link_id].ret && !ret)
+			ret = regs[link_id].ret;
+	}
+
+	/* Don't leave the other links half brought up if one of them failed */
+	if (ret)
+		max9x_des_remove_serializers(common);
+
+	kfree(regs);
+
+	return ret;
+}
+
 static int max9x_registered(struct v4l2_subdev *sd)
 {
 	struct max9x_common *common = max9x_sd_to_common(sd);
@@ -1807,7 +2078,7 @@ static int max9x_registered(struct v4l2_subdev *sd)
 			if (subdev_pdata) {
 				struct max9x_pdata *ser_pdata =
 					subdev_pdata->board_info.platform_data;
-				struct v4l2_subdev *subdev = NULL;
+				struct i2c_client *client;
 
 				WARN_ON(ser_pdata->num_serial_links < 1);
 
@@ -1819,46 +2090,31 @@ static int max9x_registered(struct v4l2_subdev *sd)
 				 * physical i2c at the same time
 				 */
 				ret = max9x_des_isolate_serial_link(common, link_id);
-				if (!ret)
-					subdev = v4l2_i2c_new_subdev_board(
-						sd->v4l2_dev,
-						common->muxc->adapter[link_id],
-						&subdev_pdata->board_info,
-						NULL);
+				client = ret ? ERR_PTR(ret) : max9x_des_new_serializer(common, link_id);
 
 				ret = max9x_des_deisolate_serial_link(common, link_id);
-				if (ret)
+				if (ret) {
+					if (!IS_ERR(client))
+						i2c_unregister_device(client);
+					max9x_des_remove_serializers(common);
 					return ret;
+				}
 
-				if (IS_ERR_OR_NULL(subdev)) {
-					dev_err(dev, "Failure registering serializer %s (0x%02x)",
+				if (IS_ERR(client)) {
+					dev_err(dev, "Failure probing serializer %s (0x%02x)",
 						subdev_pdata->board_info.type,
 						subdev_pdata->board_info.addr);
-					return PTR_ERR(subdev);
+					max9x_des_remove_serializers(common);
+					return PTR_ERR(client);
 				}
 
-				dev_dbg(dev, "Registered serializer %s (0x%02x)",
+				dev_dbg(dev, "Probed serializer %s (0x%02x)",
 					subdev_pdata->board_info.type,
 					subdev_pdata->board_info.addr);
 
-				struct max9x_common *ser_common = max9x_sd_to_common(subdev);
-
-				int remote_pad = max9x_serial_link_to_pad(ser_common, 0);
-				int local_pad = max9x_serial_link_to_pad(common, link_id);
-
-				dev_dbg(dev, "Create link from ser link 0 (pad %d) -> des link %d (pad %d)",
-						remote_pad, link_id, local_pad);
-
-				ret = media_create_pad_link(&subdev->entity, remote_pad,
-							    &sd->entity, local_pad,
-							    MEDIA_LNK_FL_IMMUTABLE |
-							    MEDIA_LNK_FL_ENABLED);
-				if (ret) {
-					dev_err(dev, "Failed creating pad link to serializer");
-					return ret;
-				}
-
-				common->serial_link[link_id].remote.client = ser_common->client;
+				/* Serializer and sensors are at their translated addresses from here on */
+				common->serial_link[link_id].remote.client = client;
+				set_bit(link_id, &common->ready_links);
 			}
 		} else {
 			struct max9x_pdata *pdata = dev->platform_data;
@@ -1927,10 +2183,7 @@ static int max9x_registered(struct v4l2_subdev *sd)
 						remote_pad, link_id,
 						local_pad);
 
-					ret = media_create_pad_link(&subdev->entity, remote_pad,
-								    &sd->entity, local_pad,
-								    MEDIA_LNK_FL_IMMUTABLE |
-								    MEDIA_LNK_FL_ENABLED);
+					ret = max9x_create_pad_link(sd, &subdev->entity, remote_pad, local_pad);
 					if (ret) {
 						dev_err(dev, "Failed creating pad link to serializer");
 						return ret;
@@ -1941,6 +2194,9 @@ static int max9x_registered(struct v4l2_subdev *sd)
 		}
 	}
 
+	if (common->type == MAX9X_DESERIALIZER)
+		return max9x_des_register_serializers(common);
+
 	return 0;
 }
 
@@ -2039,7 +2295,7 @@ static int max9x_register_v4l_subdev(struct max9x_common *common)
 	v4l2_i2c_subdev_init(sd, client, &max9x_sd_ops);
 	snprintf(sd->name, sizeof(sd->name), "%s %s", client->name, pdata->suffix);
 
-	sd->flags |= V4L2_SUBDEV_FL_HAS_DEVNODE | V4L2_SUBDEV_FL_STREAMS;
+	sd->flags |= V4L2_SUBDEV_FL_HAS_DEVNODE | V4L2_SUBDEV_FL_HAS_EVENTS | V4L2_SUBDEV_FL_STREAMS;
 	sd->internal_ops = &max9x_sd_internal_ops;
 	sd->entity.function = MEDIA_ENT_F_VID_MUX;
 
@@ -2251,10 +2507,40 @@ static void max9x_sysfs_destroy_get_link(struct max9x_common *common, unsigned i
 }
 
 /*
- * max9x_enable_line_faults() - Enables all the line fault monitors using the device tree
+ * max9x_enable_line_faults() - Enables the line fault monitors of all enabled serial links
+ *
+ * Line fault monitor N watches the cable of serial link N.
  */
 int max9x_enable_line_faults(struct max9x_common *common)
 {
+	struct device *dev = common->dev;
+	int ret;
+	int line;
+
+	if (!common->line_fault ||
+		!common->line_fault_ops ||
+		!common->line_fault_ops->enable)
+		return 0;
+
+	for (line = 0; line < common->num_line_faults; line++) {
+		if (line >= common->num_serial_links || !common->serial_link[line].enabled)
+			continue;
+
+		ret = common->line_fault_ops->enable(common, line);
+		if (ret) {
+			dev_err(dev, "Failed to enable line fault %d", line);
+			return ret;
+		}
+
+		common->line_fault[line].enabled = true;
+
+		ret = max9x_sysfs_create_line_fault_status(common, line);
+		if (ret) {
+			dev_err(dev, "Failed to create sysfs line fault status file for line %d", line);
+			return ret;
+		}
+	}
+
 	return 0;
 }
 
@@ -2287,6 +2573,49 @@ int max9x_disable_line_faults(struct max9x_common *common)
 	return final_ret;
 }
 
+/*
+ *  max9x_sysfs_create_line_fault_status() - Creates a sysfs virtual file to check line fault status
+ */
+static int max9x_sysfs_create_line_fault_status(struct max9x_common *common, unsigned int line)
+{
+	struct device *dev = common->dev;
+	struct device_attribute *line_fault_status;
+	int ret;
+	char *attr_name;
+
+	/* Kept across suspend/resume, only created once */
+	if (common->line_fault[line].line_fault_status || !common->line_fault_ops->get_status)
+		return 0;
+
+	line_fault_status = devm_kzalloc(dev, sizeof(struct device_attribute), GFP_KERNEL);
+	if (!line_fault_status) {
+		dev_err(dev, "Failed to allocate memory for line fault status");
+		return -ENOMEM;
+	}
+
+	attr_name = (char *)devm_kzalloc(dev, sizeof(char) * ATTR_NAME_LEN, GFP_KERNEL);
+	if (!attr_name) {
+		dev_err(dev, "Failed to allocate memory line fault attribute name");
+		return -ENOMEM;
+	}
+
+	ret = snprintf(attr_name, ATTR_NAME_LEN, "line-fault_%d", line);
+	if (ret < 0)
+		return ret;
+
+	line_fault_status->attr.name = attr_name;
+	line_fault_status->attr.mode = ATTR_READ_ONLY;
+	line_fault_status->show = max9x_line_fault_status_show;
+
+	ret = device_create_file(dev, line_fault_status);
+	if (ret < 0)
+		return ret;
+
+	common->line_fault[line].line_fault_status = line_fault_status;
+
+	return 0;
+}
+
 static void max9x_sysfs_destroy_line_fault_status(struct max9x_common *common, unsigned int line)
 {
 	struct device *dev = common->dev;
@@ -2295,6 +2624,169 @@ static void max9x_sysfs_destroy_line_fault_status(struct max9x_common *common, u
 		device_remove_file(dev, common->line_fault[line].line_fault_status);
 }
 
+/*
+ * max9x_status_notify() - Wakes sysfs pollers of @attr and queues a V4L2 event
+ */
+static void max9x_status_notify(struct max9x_common *common, struct device_attribute *attr,
+				u32 type, u32 id, int value)
+{
+	struct v4l2_event ev = {
+		.type = type,
+		.id = id,
+	};
+
+	if (attr)
+		sysfs_notify(&common->dev->kobj, NULL, attr->attr.name);
+
+	ev.u.data[0] = value;
+	v4l2_subdev_notify_event(&common->v4l.sd, &ev);
+}
+
+/*
+ * max9x_status_work() - Samples link lock and line fault state, notifying on changes
+ *
+ * Runs every max9x_status_poll_ms and right away when ERRB is asserted. The first
+ * sample after max9x_status_start() only records the state.
+ */
+static void max9x_status_work(struct work_struct *work)
+{
+	struct max9x_common *common = container_of(to_delayed_work(work),
+						   struct max9x_common, status_work);
+	struct device *dev = common->dev;
+	bool notify = common->status_valid;
+	unsigned int link_id;
+	unsigned int line;
+
+	for (link_id = 0; link_id < common->num_serial_links; link_id++) {
+		struct max9x_serdes_serial_link *serial_link = &common->serial_link[link_id];
+		bool locked;
+
+		if (!serial_link->enabled ||
+		    !common->serial_link_ops || !common->serial_link_ops->get_locked)
+			continue;
+
+		if (common->serial_link_ops->get_locked(common, link_id, &locked))
+			continue;
+
+		if (notify && locked != serial_link->locked) {
+			dev_info(dev, "Serial-link %d: %s", link_id, locked ? "locked" : "lost lock");
+			max9x_status_notify(common, serial_link->link_lock_status,
+					    MAX9X_EVENT_LINK_LOCK, link_id, locked);
+		}
+
+		serial_link->locked = locked;
+	}
+
+	for (line = 0; line < common->num_line_faults; line++) {
+		struct max9x_serdes_line_fault *line_fault = &common->line_fault[line];
+		int status;
+
+		if (!line_fault->enabled || !common->line_fault_ops->get_status)
+			continue;
+
+		status = common->line_fault_ops->get_status(common, line);
+		if (status < 0)
+			continue;
+
+		if (notify && status != line_fault->status) {
+			dev_info(dev, "Line fault %d: status %d", line, status);
+			max9x_status_notify(common, line_fault->line_fault_status,
+					    MAX9X_EVENT_LINE_FAULT, line, status);
+		}
+
+		line_fault->status = status;
+	}
+
+	common->status_valid = true;
+
+	if (max9x_status_poll_ms > 0)
+		schedule_delayed_work(&common->status_work, msecs_to_jiffies(max9x_status_poll_ms));
+}
+
+static irqreturn_t max9x_errb_irq(int irq, void *data)
+{
+	struct max9x_common *common = data;
+
+	mod_delayed_work(system_wq, &common->status_work, 0);
+
+	return IRQ_HANDLED;
+}
+
+/*
+ * max9x_status_init() - Requests the optional ERRB interrupt of a deserializer
+ *
+ * Serializers are not monitored, sampling them would add remote I2C traffic on
+ * every link.
+ */
+static int max9x_status_init(struct max9x_common *common)
+{
+	struct device *dev = common->dev;
+	int irq;
+	int ret;
+
+	if (common->type != MAX9X_DESERIALIZER)
+		return 0;
+
+	/* If no GPIO is found this will return NULL, and will not error */
+	common->errb_gpio = devm_gpiod_get_optional(dev, MAX9X_ERRB_GPIO_NAME, GPIOD_IN);
+	if (IS_ERR(common->errb_gpio)) {
+		dev_err(dev, "gpiod_get failed with error: %ld", PTR_ERR(common->errb_gpio));
+		return PTR_ERR(common->errb_gpio);
+	}
+
+	if (!common->errb_gpio)
+		return 0;
+
+	ret = gpiod_to_irq(common->errb_gpio);
+	if (ret < 0) {
+		dev_warn(dev, "No interrupt for %s, polling only: %d", MAX9X_ERRB_GPIO_NAME, ret);
+		return 0;
+	}
+
+	irq = ret;
+
+	/* ERRB is active low and stays asserted until the error is read back */
+	ret = devm_request_threaded_irq(dev, irq, NULL, max9x_errb_irq,
+					IRQF_TRIGGER_FALLING | IRQF_ONESHOT | IRQF_NO_AUTOEN,
+					dev_name(dev), common);
+	if (ret) {
+		dev_warn(dev, "Failed to request %s interrupt, polling only: %d",
+			 MAX9X_ERRB_GPIO_NAME, ret);
+		return 0;
+	}
+
+	common->errb_irq = irq;
+
+	return 0;
+}
+
+static void max9x_status_start(struct max9x_common *common)
+{
+	if (common->type != MAX9X_DESERIALIZER || common->status_running)
+		return;
+
+	common->status_running = true;
+	common->status_valid = false;
+
+	if (common->errb_irq >= 0)
+		enable_irq(common->errb_irq);
+
+	schedule_delayed_work(&common->status_work, 0);
+}
+
+static void max9x_status_stop(struct max9x_common *common)
+{
+	if (!common->status_running)
+		return;
+
+	common->status_running = false;
+
+	if (common->errb_irq >= 0)
+		disable_irq(common->errb_irq);
+
+	cancel_delayed_work_sync(&common->status_work);
+}
+
 static int max9x_parse_pdata(struct max9x_common *common, struct max9x_pdata *pdata)
 {
 	int ret;
@@ -2512,6 +3004,11 @@ int max9x_select_i2c_chan(struct i2c_mux_core *muxc, u32 chan_id)
 
 	do {
 		mutex_lock(&common->isolate_mutex);
+		if (common->shared_links & BIT(chan_id)) {
+			mutex_unlock(&common->isolate_mutex);
+			return 0;
+		}
+
 		if (common->selected_link < 0 || chan_id == common->selected_link)
 			break;
 
@@ -2544,7 +3041,15 @@ int max9x_deselect_i2c_chan(struct i2c_mux_core *muxc, u32 chan_id)
 		return -EINVAL;
 
 	mutex_lock(&common->isolate_mutex);
-	if (common->serial_link_ops && common->serial_link_ops->deselect)
+	if (common->shared_links & BIT(chan_id)) {
+		mutex_unlock(&common->isolate_mutex);
+		return 0;
+	}
+
+	/* Reopen the shared links after a transfer on a link outside of them */
+	if (common->shared_links)
+		ret = common->serial_link_ops->select_links(common, common->shared_links);
+	else if (common->serial_link_ops && common->serial_link_ops->deselect)
 		ret = common->serial_link_ops->deselect(common, chan_id);
 
 	common->selected_link = -1;
@@ -2553,6 +3058,99 @@ int max9x_deselect_i2c_chan(struct i2c_mux_core *muxc, u32 chan_id)
 	return ret;
 }
 
+/*
+ * The remote devices of several links can be addressed at once if every
+ * address used on the local bus is unique, and none of them is the physical
+ * address of a remote device, which would answer on all of the links.
+ */
+static bool max9x_des_has_unique_addrs(struct max9x_common *common, unsigned long mask)
+{
+	DECLARE_BITMAP(virt_addrs, MAX9X_I2C_NUM_ADDRS) = { 0 };
+	DECLARE_BITMAP(phys_addrs, MAX9X_I2C_NUM_ADDRS) = { 0 };
+	unsigned int link_id;
+
+	for_each_set_bit(link_id, &mask, common->num_serial_links) {
+		struct max9x_subdev_pdata *ser = common->serial_link[link_id].remote.pdata;
+		struct max9x_pdata *ser_pdata = ser->board_info.platform_data;
+		unsigned int i;
+
+		if (__test_and_set_bit(ser->board_info.addr, virt_addrs))
+			return false;
+
+		__set_bit(ser->phys_addr ? ser->phys_addr : ser->board_info.addr, phys_addrs);
+
+		for (i = 0; ser_pdata && i < ser_pdata->num_subdevs; i++) {
+			struct max9x_subdev_pdata *sensor = &ser_pdata->subdevs[i];
+
+			if (__test_and_set_bit(sensor->board_info.addr, virt_addrs))
+				return false;
+
+			__set_bit(sensor->phys_addr ? sensor->phys_addr : sensor->board_info.addr,
+				  phys_addrs);
+		}
+	}
+
+	return !bitmap_intersects(virt_addrs, phys_addrs, MAX9X_I2C_NUM_ADDRS);
+}
+
+/*
+ * Once every serializer and sensor sits at a unique translated address, keep
+ * the remote control channel of all the links open instead of selecting one
+ * link per transfer. Transfers on different links then no longer wait for each
+ * other's selection, and no longer need a select and deselect write each.
+ */
+static void max9x_des_update_shared_links(struct max9x_common *common)
+{
+	unsigned long timeout = jiffies + msecs_to_jiffies(10000);
+	unsigned long mask = 0;
+	unsigned int link_id;
+	int ret;
+
+	if (common->type != MAX9X_DESERIALIZER || !common->serial_link_ops ||
+	    !common->serial_link_ops->select_links)
+		return;
+
+	for (link_id = 0; link_id < common->num_serial_links; link_id++) {
+		struct max9x_serdes_serial_link *serial_link = &common->serial_link[link_id];
+
+		if (serial_link->enabled && serial_link->remote.pdata)
+			mask |= BIT(link_id);
+	}
+
+	if (hweight_long(mask) < 2 || (common->ready_links & mask) != mask)
+		return;
+
+	if (!max9x_des_has_unique_addrs(common, mask)) {
+		dev_dbg(common->dev, "Remote addresses not unique, keeping exclusive link selection");
+		return;
+	}
+
+	do {
+		mutex_lock(&common->isolate_mutex);
+		if (common->isolated_link < 0 && common->selected_link < 0)
+			break;
+
+		mutex_unlock(&common->isolate_mutex);
+
+		usleep_range(1000, 1050);
+
+		if (time_is_before_jiffies(timeout)) {
+			dev_warn(common->dev, "Timeout waiting to share links");
+			return;
+		}
+	} while (1);
+
+	if (common->shared_links != mask) {
+		ret = common->serial_link_ops->select_links(common, mask);
+		if (!ret) {
+			common->shared_links = mask;
+			dev_info(common->dev, "Serial-links 0x%lx: shared remote I2C", mask);
+		}
+	}
+
+	mutex_unlock(&common->isolate_mutex);
+}
+
 int max9x_des_isolate_serial_link(struct max9x_common *common, unsigned int link_id)
 {
 	int ret = 0;
@@ -2583,6 +3181,14 @@ int max9x_des_isolate_serial_link(struct max9x_common *common, unsigned int link
 			return -ETIMEDOUT;
 	} while (1);
 
+	/* The isolated serializer may go back to its physical address */
+	if (common->shared_links) {
+		common->shared_links = 0;
+		if (common->serial_link_ops->deselect)
+			common->serial_link_ops->deselect(common, link_id);
+	}
+	clear_bit(link_id, &common->ready_links);
+
 	common->isolated_link = link_id;
 	if (common->serial_link_ops && common->serial_link_ops->isolate)
 		ret = common->serial_link_ops->isolate(common, link_id);
@@ -2615,7 +3221,7 @@ int max9x_des_deisolate_serial_link(struct max9x_common *common, unsigned int li
 
 ssize_t max9x_link_status_show(struct device *dev, struct device_attribute *attr, char *buf)
 {
-	struct max9x_common *common = dev_get_drvdata(dev);
+	struct max9x_common *common = max9x_client_to_common(to_i2c_client(dev));
 	int link;
 	int ret;
 	bool locked;
@@ -2636,6 +3242,28 @@ ssize_t max9x_link_status_show(struct device *dev, struct device_attribute *attr
 	return -EINVAL;
 }
 
+ssize_t max9x_line_fault_status_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	struct max9x_common *common = max9x_client_to_common(to_i2c_client(dev));
+	int line;
+	int ret;
+
+	ret = sscanf(attr->attr.name, "line-fault_%d", &line);
+	if (ret < 0)
+		return ret;
+
+	if (common->line_fault_ops && common->line_fault_ops->get_status) {
+		ret = common->line_fault_ops->get_status(common, line);
+		if (ret < 0)
+			return ret;
+
+		return sysfs_emit(buf, "%d", ret);
+	}
+
+	dev_err(dev, "get_status not defined");
+	return -EINVAL;
+}
+
 int max9x_setup_translations(struct max9x_common *common)
 {
 	int err = 0;
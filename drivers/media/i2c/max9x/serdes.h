@@ -35,6 +35,7 @@
 #include <linux/mutex.h>
 #include <linux/platform_device.h>
 #include <linux/version.h>
+#include <linux/workqueue.h>
 #include <media/media-entity.h>
 #include <media/v4l2-common.h>
 #include <media/v4l2-ctrls.h>
@@ -48,13 +49,28 @@
 #define MAX9X_VDD_REGULATOR_NAME "vdd"
 #define MAX9X_POC_REGULATOR_NAME "poc"
 #define MAX9X_RESET_GPIO_NAME "reset"
+#define MAX9X_ERRB_GPIO_NAME "errb"
 #define MAX9X_DEV_ID 0xD
 #define MAX9X_DEV_REV_FIELD GENMASK(3, 0)
+#define MAX9X_I2C_NUM_ADDRS 0x80
+
+/* Device ID polling after reset and address remap, see max9x_wait_ready() */
+#define MAX9X_READY_POLL_US (1000)
+#define MAX9X_READY_TIMEOUT_US (500000)
 
 /*Used for device attributes*/
 #define ATTR_NAME_LEN (30) /* arbitrary number used to allocate an attribute */
 #define ATTR_READ_ONLY (0444)
 
+/*
+ * Private V4L2 events raised on link lock and line fault changes. The event id
+ * is the serial link or line fault index, u.data[0] holds the new lock state or
+ * line fault status.
+ */
+#define MAX9X_EVENT_LINK_LOCK (V4L2_EVENT_PRIVATE_START + 1)
+#define MAX9X_EVENT_LINE_FAULT (V4L2_EVENT_PRIVATE_START + 2)
+#define MAX9X_EVENT_QUEUE_LEN (8)
+
 #define MAX9X_LINK_FREQ_MBPS_TO_HZ(mbps) (((unsigned long long)(mbps)*1000000ULL)/2ULL)
 #define MAX9X_LINK_FREQ_HZ_TO_MBPS(hz) (((unsigned long long)(hz)*2ULL)/1000000ULL)
 #define MAX9X_LINK_FREQ_MBPS_TO_REG(mbps) ((mbps)/100U)
@@ -238,11 +254,13 @@ struct max9x_serdes_serial_link {
 	struct regmap *map;
 	struct max9x_serdes_serial_config config;
 	struct device_attribute *link_lock_status;
+	bool locked; /* last lock state seen by the status monitor */
 };
 
 struct max9x_serdes_line_fault {
 	bool enabled;
 	struct device_attribute *line_fault_status;
+	int status; /* last status seen by the status monitor */
 };
 
 struct max9x_common {
@@ -284,6 +302,17 @@ struct max9x_common {
 	struct mutex isolate_mutex;
 	int isolated_link;
 	int selected_link;
+	/* Links whose serializer and sensors are at their translated addresses */
+	unsigned long ready_links;
+	/* Links selected together, see max9x_des_update_shared_links() */
+	unsigned long shared_links;
+
+	/* Link lock and line fault monitor, see max9x_status_work() */
+	struct gpio_desc *errb_gpio;
+	int errb_irq;
+	struct delayed_work status_work;
+	bool status_running;
+	bool status_valid;
 	bool external_refclk_enable;
 };
 
@@ -319,6 +348,7 @@ struct max9x_serial_link_ops {
 	int (*get_locked)(struct max9x_common *common, unsigned int link, bool *locked);
 	int (*isolate)(struct max9x_common *common, unsigned int link);
 	int (*deisolate)(struct max9x_common *common, unsigned int link);
+	int (*select_links)(struct max9x_common *common, unsigned long mask);
 };
 
 struct max9x_csi_link_ops {
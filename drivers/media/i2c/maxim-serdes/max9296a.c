@@ -10,6 +10,7 @@
 #include <linux/module.h>
 #include <linux/of_graph.h>
 #include <linux/regmap.h>
+#include <linux/unaligned.h>
 
 #include <media/mipi-csi2.h>
 
@@ -42,6 +43,12 @@
 #define MAX9296A_CTRL2				0x12
 #define MAX9296A_CTRL2_RESET_ONESHOT_B		BIT(5)
 
+#define MAX9296A_CTRL3				0x13
+#define MAX9296A_CTRL3_LOCKED			BIT(3)
+
+#define MAX9296A_CNT0(x)			(0x22 + (x))
+#define MAX9296A_CNT2				0x24
+
 #define MAX9296A_MIPI_TX0(x)			(0x28 + (x) * 0x5000)
 #define MAX9296A_MIPI_TX0_RX_FEC_EN		BIT(1)
 
@@ -140,6 +147,26 @@
 
 #define MAX9296A_MIPI_PHY20(x)			(0x344 + (x))
 
+#define MAX9296A_FSYNC_0			0x3e0
+#define MAX9296A_FSYNC_0_FSYNC_METH		GENMASK(1, 0)
+#define MAX9296A_FSYNC_0_FSYNC_METH_MANUAL	0b00
+#define MAX9296A_FSYNC_0_FSYNC_MODE		GENMASK(3, 2)
+#define MAX9296A_FSYNC_0_FSYNC_MODE_GEN_ON	0b00
+#define MAX9296A_FSYNC_0_FSYNC_MODE_GEN_OFF	0b11
+
+#define MAX9296A_FSYNC_5			0x3e5
+#define MAX9296A_FSYNC_PERIOD_MAX		GENMASK(23, 0)
+
+#define MAX9296A_FSYNC_15			0x3ef
+#define MAX9296A_FSYNC_15_FS_LINK		GENMASK(1, 0)
+#define MAX9296A_FSYNC_15_FS_USE_XTAL		BIT(6)
+#define MAX9296A_FSYNC_15_FS_GPIO_TYPE_GMSL2	BIT(7)
+
+#define MAX9296A_FSYNC_17			0x3f1
+#define MAX9296A_FSYNC_17_FSYNC_TX_ID		GENMASK(7, 3)
+
+#define MAX9296A_FSYNC_XTAL_HZ			25000000
+
 #define MAX9296A_MIPI_TX3(x)			(0x403 + (x) * 0x40)
 #define MAX9296A_MIPI_TX3_DESKEW_INIT_8X32K	FIELD_PREP(GENMASK(2, 0), 0b001)
 #define MAX9296A_MIPI_TX3_DESKEW_INIT_AUTO	BIT(7)
@@ -339,6 +366,32 @@ static int max9296a_log_phy_status(struct max_des *des,
 	return 0;
 }
 
+static int max9296a_get_phy_stats(struct max_des *des, struct max_des_phy *phy,
+				  struct max_des_phy_stats *stats)
+{
+	struct max9296a_priv *priv = des_to_priv(des);
+	unsigned int index = phy->index;
+	unsigned int val;
+	int ret;
+
+	if (!priv->info->supports_phy_log)
+		return -EOPNOTSUPP;
+
+	ret = regmap_read(priv->regmap, MAX9296A_MIPI_PHY18, &val);
+	if (ret)
+		return ret;
+
+	stats->csi2_pkt_cnt = field_get(MAX9296A_MIPI_PHY18_CSI2_TX_PKT_CNT(index), val);
+
+	ret = regmap_read(priv->regmap, MAX9296A_MIPI_PHY20(index), &val);
+	if (ret)
+		return ret;
+
+	stats->phy_pkt_cnt = val;
+
+	return 0;
+}
+
 static int max9296a_set_enable(struct max_des *des, bool enable)
 {
 	struct max9296a_priv *priv = des_to_priv(des);
@@ -710,6 +763,41 @@ static int max96714_set_pipe_enable(struct max_des *des, struct max_des_pipe *pi
 				  MAX9296A_VIDEO_PIPE_EN_MASK(index - 1), enable);
 }
 
+static int max9296a_set_pipes_enable(struct max_des *des, unsigned int mask,
+				     bool enable)
+{
+	struct max9296a_priv *priv = des_to_priv(des);
+	unsigned int val = 0;
+	unsigned int i;
+
+	for (i = 0; i < des->ops->num_pipes; i++) {
+		unsigned int index = max9296a_pipe_id(priv, &des->pipes[i]);
+
+		if (mask & BIT(i))
+			val |= MAX9296A_REG2_VID_EN(index);
+	}
+
+	return regmap_assign_bits(priv->regmap, MAX9296A_REG2, val, enable);
+}
+
+static int max96714_set_pipes_enable(struct max_des *des, unsigned int mask,
+				     bool enable)
+{
+	struct max9296a_priv *priv = des_to_priv(des);
+	unsigned int val = 0;
+	unsigned int i;
+
+	for (i = 0; i < des->ops->num_pipes; i++) {
+		unsigned int index = max9296a_pipe_id(priv, &des->pipes[i]);
+
+		if (mask & BIT(i))
+			val |= MAX9296A_VIDEO_PIPE_EN_MASK(index - 1);
+	}
+
+	return regmap_assign_bits(priv->regmap, MAX9296A_VIDEO_PIPE_EN, val,
+				  enable);
+}
+
 static int max96714_set_pipe_tunnel_enable(struct max_des *des,
 					   struct max_des_pipe *pipe, bool enable)
 {
@@ -906,6 +994,139 @@ static int max9296a_set_link_version(struct max_des *des,
 				  MAX9296A_REG4_GMSL3_X(index), gmsl3_en);
 }
 
+static int max9296a_get_link_lock(struct max_des *des,
+				  struct max_des_link *link, bool *locked)
+{
+	struct max9296a_priv *priv = des_to_priv(des);
+	unsigned int val;
+	int ret;
+
+	/*
+	 * CTRL3 only reports the lock state of link A, or of whichever link
+	 * is selected when the links are used one at a time.
+	 */
+	if (link->index && priv->info->has_per_link_reset)
+		return -EOPNOTSUPP;
+
+	ret = regmap_read(priv->regmap, MAX9296A_CTRL3, &val);
+	if (ret)
+		return ret;
+
+	*locked = !!(val & MAX9296A_CTRL3_LOCKED);
+
+	return 0;
+}
+
+static int max9296a_get_pipe_video_lock(struct max_des *des,
+					struct max_des_pipe *pipe, bool *locked)
+{
+	struct max9296a_priv *priv = des_to_priv(des);
+	unsigned int index = max9296a_pipe_id(priv, pipe);
+	unsigned int val;
+	int ret;
+
+	ret = regmap_read(priv->regmap, MAX9296A_VPRBS(index), &val);
+	if (ret)
+		return ret;
+
+	*locked = !!(val & MAX9296A_VPRBS_VIDEO_LOCK);
+
+	return 0;
+}
+
+static int max9296a_set_fsync(struct max_des *des,
+			      const struct max_des_fsync *fsync)
+{
+	struct max9296a_priv *priv = des_to_priv(des);
+	u64 period;
+	u8 buf[3];
+	int ret;
+
+	if (!fsync->enable)
+		return regmap_update_bits(priv->regmap, MAX9296A_FSYNC_0,
+					  MAX9296A_FSYNC_0_FSYNC_MODE,
+					  FIELD_PREP(MAX9296A_FSYNC_0_FSYNC_MODE,
+						     MAX9296A_FSYNC_0_FSYNC_MODE_GEN_OFF));
+
+	/* The period is counted in crystal clock cycles. */
+	period = div_u64((u64)fsync->period_us * MAX9296A_FSYNC_XTAL_HZ, USEC_PER_SEC);
+	if (!period || period > MAX9296A_FSYNC_PERIOD_MAX)
+		return -ERANGE;
+
+	ret = regmap_write(priv->regmap, MAX9296A_FSYNC_15,
+			   MAX9296A_FSYNC_15_FS_GPIO_TYPE_GMSL2 |
+			   MAX9296A_FSYNC_15_FS_USE_XTAL |
+			   field_prep(MAX9296A_FSYNC_15_FS_LINK, fsync->links));
+	if (ret)
+		return ret;
+
+	ret = regmap_update_bits(priv->regmap, MAX9296A_FSYNC_17,
+				 MAX9296A_FSYNC_17_FSYNC_TX_ID,
+				 FIELD_PREP(MAX9296A_FSYNC_17_FSYNC_TX_ID, fsync->tx_id));
+	if (ret)
+		return ret;
+
+	put_unaligned_le24(period, buf);
+
+	ret = regmap_bulk_write(priv->regmap, MAX9296A_FSYNC_5, buf, sizeof(buf));
+	if (ret)
+		return ret;
+
+	/* Generation starts once the mode is set. */
+	return regmap_update_bits(priv->regmap, MAX9296A_FSYNC_0,
+				  MAX9296A_FSYNC_0_FSYNC_METH |
+				  MAX9296A_FSYNC_0_FSYNC_MODE,
+				  FIELD_PREP(MAX9296A_FSYNC_0_FSYNC_METH,
+					     MAX9296A_FSYNC_0_FSYNC_METH_MANUAL) |
+				  FIELD_PREP(MAX9296A_FSYNC_0_FSYNC_MODE,
+					     MAX9296A_FSYNC_0_FSYNC_MODE_GEN_ON));
+}
+
+static int max9296a_get_link_stats(struct max_des *des,
+				   struct max_des_link *link,
+				   struct max_des_link_stats *stats)
+{
+	struct max9296a_priv *priv = des_to_priv(des);
+	unsigned int val;
+	int ret;
+
+	if (link->index && !priv->info->has_per_link_reset)
+		return -EOPNOTSUPP;
+
+	/* Error counters are cleared on read. */
+	ret = regmap_read(priv->regmap, MAX9296A_CNT0(link->index), &val);
+	if (ret)
+		return ret;
+
+	stats->dec_err = val;
+
+	/* There is a single idle error counter, for link A. */
+	stats->idle_err = 0;
+
+	if (link->index)
+		return 0;
+
+	ret = regmap_read(priv->regmap, MAX9296A_CNT2, &val);
+	if (ret)
+		return ret;
+
+	stats->idle_err = val;
+
+	return 0;
+}
+
+static int max9296a_des_reset_link(struct max_des *des,
+				   struct max_des_link *link)
+{
+	struct max9296a_priv *priv = des_to_priv(des);
+
+	/* Without per-link reset, CTRL0 resets whichever link is selected. */
+	if (!priv->info->has_per_link_reset)
+		return max9296a_reset_link(priv, 0);
+
+	return max9296a_reset_link(priv, link->index);
+}
+
 static int max9296a_set_tpg_timings(struct max9296a_priv *priv,
 				    const struct max_serdes_tpg_timings *tm)
 {
@@ -942,6 +1163,7 @@ static int max9296a_set_tpg_timings(struct max9296a_priv *priv,
 static int max9296a_set_tpg_clk(struct max9296a_priv *priv, u32 clock)
 {
 	bool patgen_clk_src = 0;
+	unsigned int i;
 	u8 pin_drv_en;
 	int ret;
 
@@ -966,16 +1188,17 @@ static int max9296a_set_tpg_clk(struct max9296a_priv *priv, u32 clock)
 		return -EINVAL;
 	}
 
-	/*
-	 * TPG data is always injected on link 0, which is always routed to
-	 * pipe 0.
-	 */
-	ret = regmap_update_bits(priv->regmap, MAX9296A_VPRBS(0),
-				 MAX9296A_VPRBS_PATGEN_CLK_SRC,
-				 FIELD_PREP(MAX9296A_VPRBS_PATGEN_CLK_SRC,
-					    patgen_clk_src));
-	if (ret)
-		return ret;
+	/* TPG data is injected into all pipes, clock them all the same. */
+	for (i = 0; i < priv->des.ops->num_pipes; i++) {
+		unsigned int index = max9296a_pipe_id(priv, &priv->des.pipes[i]);
+
+		ret = regmap_update_bits(priv->regmap, MAX9296A_VPRBS(index),
+					 MAX9296A_VPRBS_PATGEN_CLK_SRC,
+					 FIELD_PREP(MAX9296A_VPRBS_PATGEN_CLK_SRC,
+						    patgen_clk_src));
+		if (ret)
+			return ret;
+	}
 
 	return regmap_update_bits(priv->regmap, MAX9296A_IO_CHK0,
 				  MAX9296A_IO_CHK0_PIN_DRV_EN_0,
@@ -1063,6 +1286,12 @@ static const struct max_des_ops max9296a_common_ops = {
 	.set_tpg = max9296a_set_tpg,
 	.select_links = max9296a_select_links,
 	.set_link_version = max9296a_set_link_version,
+	.get_link_lock = max9296a_get_link_lock,
+	.get_pipe_video_lock = max9296a_get_pipe_video_lock,
+	.reset_link = max9296a_des_reset_link,
+	.get_link_stats = max9296a_get_link_stats,
+	.get_phy_stats = max9296a_get_phy_stats,
+	.set_fsync = max9296a_set_fsync,
 };
 
 static int max9296a_probe(struct i2c_client *client)
@@ -1122,6 +1351,7 @@ static int max9296a_probe(struct i2c_client *client)
 	ops->num_links = priv->info->ops->num_links;
 	ops->phys_configs = priv->info->ops->phys_configs;
 	ops->set_pipe_enable = priv->info->ops->set_pipe_enable;
+	ops->set_pipes_enable = priv->info->ops->set_pipes_enable;
 	ops->set_pipe_stream_id = priv->info->ops->set_pipe_stream_id;
 	ops->set_pipe_tunnel_phy = priv->info->ops->set_pipe_tunnel_phy;
 	ops->set_pipe_tunnel_enable = priv->info->ops->set_pipe_tunnel_enable;
@@ -1159,6 +1389,7 @@ static const struct max_des_ops max9296a_ops = {
 	.modes = BIT(MAX_SERDES_GMSL_PIXEL_MODE),
 	.set_pipe_stream_id = max9296a_set_pipe_stream_id,
 	.set_pipe_enable = max9296a_set_pipe_enable,
+	.set_pipes_enable = max9296a_set_pipes_enable,
 	.needs_single_link_version = true,
 	.needs_unique_stream_id = true,
 	.phys_configs = {
@@ -1187,6 +1418,7 @@ static const struct max_des_ops max96714_ops = {
 		 BIT(MAX_SERDES_GMSL_TUNNEL_MODE),
 	.set_pipe_stream_id = max96714_set_pipe_stream_id,
 	.set_pipe_enable = max96714_set_pipe_enable,
+	.set_pipes_enable = max96714_set_pipes_enable,
 	.set_pipe_tunnel_enable = max96714_set_pipe_tunnel_enable,
 	.phys_configs = {
 		.num_configs = ARRAY_SIZE(max96714_phys_configs),
@@ -1231,6 +1463,7 @@ static const struct max_des_ops max96714f_ops = {
 		 BIT(MAX_SERDES_GMSL_TUNNEL_MODE),
 	.set_pipe_stream_id = max96714_set_pipe_stream_id,
 	.set_pipe_enable = max96714_set_pipe_enable,
+	.set_pipes_enable = max96714_set_pipes_enable,
 	.set_pipe_tunnel_enable = max96714_set_pipe_tunnel_enable,
 	.phys_configs = {
 		.num_configs = ARRAY_SIZE(max96714_phys_configs),
@@ -1261,6 +1494,7 @@ static const struct max_des_ops max96716a_ops = {
 	.set_pipe_stream_id = max96714_set_pipe_stream_id,
 	.set_pipe_link = max96716a_set_pipe_link,
 	.set_pipe_enable = max96714_set_pipe_enable,
+	.set_pipes_enable = max96714_set_pipes_enable,
 	.set_pipe_tunnel_phy = max96716a_set_pipe_tunnel_phy,
 	.set_pipe_tunnel_enable = max96714_set_pipe_tunnel_enable,
 	.use_atr = true,
@@ -1293,6 +1527,7 @@ static const struct max_des_ops max96792a_ops = {
 		 BIT(MAX_SERDES_GMSL_TUNNEL_MODE),
 	.set_pipe_stream_id = max96714_set_pipe_stream_id,
 	.set_pipe_enable = max96714_set_pipe_enable,
+	.set_pipes_enable = max96714_set_pipes_enable,
 	.set_pipe_tunnel_phy = max96716a_set_pipe_tunnel_phy,
 	.set_pipe_tunnel_enable = max96714_set_pipe_tunnel_enable,
 	.use_atr = true,
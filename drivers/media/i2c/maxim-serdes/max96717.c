@@ -1382,6 +1382,7 @@ static const struct max_serdes_tpg_entry max96717_tpg_entries[] = {
 
 static const struct max_ser_ops max96717_ops = {
 	.num_i2c_xlates = 2,
+	.num_vc_ids = 16,
 	.phys_configs = {
 		.num_configs = ARRAY_SIZE(max96717_phys_configs),
 		.configs = max96717_phys_configs,
@@ -1640,7 +1641,7 @@ static int max96717_probe(struct i2c_client *client)
 	if (!ops)
 		return -ENOMEM;
 
-	priv->info = device_get_match_data(dev);
+	priv->info = i2c_get_match_data(client);
 	if (!priv->info) {
 		dev_err(dev, "Failed to get match data\n");
 		return -ENODEV;
@@ -1726,6 +1727,15 @@ static const struct of_device_id max96717_of_ids[] = {
 };
 MODULE_DEVICE_TABLE(of, max96717_of_ids);
 
+static const struct i2c_device_id max96717_i2c_ids[] = {
+	{ "max9295a", (kernel_ulong_t)&max9295a_info },
+	{ "max96717", (kernel_ulong_t)&max96717_info },
+	{ "max96717f", (kernel_ulong_t)&max96717_info },
+	{ "max96793", (kernel_ulong_t)&max96717_info },
+	{ }
+};
+MODULE_DEVICE_TABLE(i2c, max96717_i2c_ids);
+
 static struct i2c_driver max96717_i2c_driver = {
 	.driver	= {
 		.name = MAX96717_NAME,
@@ -1734,6 +1744,7 @@ static struct i2c_driver max96717_i2c_driver = {
 	},
 	.probe = max96717_probe,
 	.remove = max96717_remove,
+	.id_table = max96717_i2c_ids,
 };
 
 module_i2c_driver(max96717_i2c_driver);
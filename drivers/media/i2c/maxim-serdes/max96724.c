@@ -12,6 +12,7 @@
 #include <linux/module.h>
 #include <linux/of_graph.h>
 #include <linux/regmap.h>
+#include <linux/unaligned.h>
 
 #include "max_des.h"
 
@@ -20,6 +21,9 @@
 #define MAX96724_REG6				0x6
 #define MAX96724_REG6_LINK_EN			GENMASK(3, 0)
 
+#define MAX96724_LINK_LOCK(x)			((x) ? 0x9 + (x) : 0x1a)
+#define MAX96724_LINK_LOCK_LOCKED		BIT(3)
+
 #define MAX96724_DEBUG_EXTRA			0x9
 #define MAX96724_DEBUG_EXTRA_PCLK_SRC		GENMASK(1, 0)
 #define MAX96724_DEBUG_EXTRA_PCLK_SRC_25MHZ	0b00
@@ -37,6 +41,9 @@
 #define MAX96724_CTRL1				0x18
 #define MAX96724_CTRL1_RESET_ONESHOT		GENMASK(3, 0)
 
+#define MAX96724_CNT0(x)			(0x35 + (x))
+#define MAX96724_CNT4(x)			(0x39 + (x))
+
 #define MAX96724_VIDEO_PIPE_SEL(p)		(0xf0 + (p) / 2)
 #define MAX96724_VIDEO_PIPE_SEL_STREAM(p)	(GENMASK(1, 0) << (4 * ((p) % 2)))
 #define MAX96724_VIDEO_PIPE_SEL_LINK(p)		(GENMASK(3, 2) << (4 * ((p) % 2)))
@@ -51,6 +58,10 @@
 #define MAX96724_VPRBS_PATGEN_CLK_SRC_150MHZ	0b0
 #define MAX96724_VPRBS_PATGEN_CLK_SRC_375MHZ	0b1
 
+#define MAX96724_BACKTOP11(p)			(0x40a + (p) / 4 * 0x20)
+#define MAX96724_BACKTOP11_LMO(p)		BIT((p) % 4)
+#define MAX96724_BACKTOP11_CMD_OVERFLOW(p)	BIT(4 + (p) % 4)
+
 #define MAX96724_BACKTOP12			0x40b
 #define MAX96724_BACKTOP12_CSI_OUT_EN		BIT(1)
 
@@ -79,6 +90,30 @@
 #define MAX96724_BACKTOP32_BPP10DBL1		BIT(6)
 #define MAX96724_BACKTOP32_BPP10DBL1_MODE	BIT(7)
 
+#define MAX96724_FSYNC_0			0x4a0
+#define MAX96724_FSYNC_0_FSYNC_METH		GENMASK(1, 0)
+#define MAX96724_FSYNC_0_FSYNC_METH_MANUAL	0b00
+#define MAX96724_FSYNC_0_FSYNC_MODE		GENMASK(3, 2)
+#define MAX96724_FSYNC_0_FSYNC_MODE_GEN_ON	0b00
+#define MAX96724_FSYNC_0_FSYNC_MODE_GEN_OFF	0b11
+
+#define MAX96724_FSYNC_5			0x4a5
+#define MAX96724_FSYNC_PERIOD_MAX		GENMASK(23, 0)
+
+#define MAX96724_FSYNC_15			0x4af
+#define MAX96724_FSYNC_15_FS_LINK		GENMASK(3, 0)
+#define MAX96724_FSYNC_15_FS_USE_XTAL		BIT(6)
+#define MAX96724_FSYNC_15_FS_GPIO_TYPE_GMSL2	BIT(7)
+
+#define MAX96724_FSYNC_17			0x4b1
+#define MAX96724_FSYNC_17_FSYNC_TX_ID		GENMASK(7, 3)
+
+#define MAX96724_FSYNC_XTAL_HZ			25000000
+
+#define MAX96724_MIPI_TX_EXT(p, x)		(0x800 + (p) * 0x10 + (x))
+#define MAX96724_MIPI_TX_EXT_MAP_SRC_VC_H	GENMASK(2, 0)
+#define MAX96724_MIPI_TX_EXT_MAP_DST_VC_H	GENMASK(5, 3)
+
 #define MAX96724_MIPI_PHY0			0x8a0
 #define MAX96724_MIPI_PHY0_PHY_CONFIG		GENMASK(4, 0)
 #define MAX96724_MIPI_PHY0_PHY_4X2		BIT(0)
@@ -130,6 +165,7 @@
 #define MAX96724_MIPI_TX4_DESKEW_PER_AUTO	BIT(7)
 
 #define MAX96724_MIPI_TX10(x)			(0x90a + (x) * 0x40)
+#define MAX96724_MIPI_TX10_CSI2_VCX_EN		BIT(3)
 #define MAX96724_MIPI_TX10_CSI2_CPHY_EN		BIT(5)
 #define MAX96724_MIPI_TX10_CSI2_LANE_CNT	GENMASK(7, 6)
 
@@ -385,6 +421,29 @@ static int max96724_log_phy_status(struct max_des *des,
 	return 0;
 }
 
+static int max96724_get_phy_stats(struct max_des *des, struct max_des_phy *phy,
+				  struct max_des_phy_stats *stats)
+{
+	struct max96724_priv *priv = des_to_priv(des);
+	unsigned int index = max96724_phy_id(des, phy);
+	unsigned int val;
+	int ret;
+
+	ret = regmap_read(priv->regmap, MAX96724_MIPI_PHY25(index), &val);
+	if (ret)
+		return ret;
+
+	stats->csi2_pkt_cnt = field_get(MAX96724_MIPI_PHY25_CSI2_TX_PKT_CNT(index), val);
+
+	ret = regmap_read(priv->regmap, MAX96724_MIPI_PHY27(index), &val);
+	if (ret)
+		return ret;
+
+	stats->phy_pkt_cnt = field_get(MAX96724_MIPI_PHY27_PHY_PKT_CNT(index), val);
+
+	return 0;
+}
+
 static int max96724_set_enable(struct max_des *des, bool enable)
 {
 	struct max96724_priv *priv = des_to_priv(des);
@@ -511,6 +570,15 @@ static int max96724_init_phy(struct max_des *des, struct max_des_phy *phy)
 	if (ret)
 		return ret;
 
+	/*
+	 * Extended Virtual Channel bits are zero for VCs 0 to 3, so it is
+	 * safe to always enable them.
+	 */
+	ret = regmap_set_bits(priv->regmap, MAX96724_MIPI_TX10(index),
+			      MAX96724_MIPI_TX10_CSI2_VCX_EN);
+	if (ret)
+		return ret;
+
 	/* Configure lane mapping. */
 	val = 0;
 	for (i = 0; i < num_hw_data_lanes ; i++) {
@@ -698,7 +766,6 @@ static int max96724_set_pipe_remap(struct max_des *des,
 	int ret;
 
 	/* Set source Data Type and Virtual Channel. */
-	/* TODO: implement extended Virtual Channel. */
 	ret = regmap_write(priv->regmap, MAX96724_MIPI_TX13(index, i),
 			   FIELD_PREP(MAX96724_MIPI_TX13_MAP_SRC_DT,
 				      remap->from_dt) |
@@ -708,7 +775,6 @@ static int max96724_set_pipe_remap(struct max_des *des,
 		return ret;
 
 	/* Set destination Data Type and Virtual Channel. */
-	/* TODO: implement extended Virtual Channel. */
 	ret = regmap_write(priv->regmap, MAX96724_MIPI_TX14(index, i),
 			   FIELD_PREP(MAX96724_MIPI_TX14_MAP_DST_DT,
 				      remap->to_dt) |
@@ -717,6 +783,15 @@ static int max96724_set_pipe_remap(struct max_des *des,
 	if (ret)
 		return ret;
 
+	/* Set extended source and destination Virtual Channel. */
+	ret = regmap_write(priv->regmap, MAX96724_MIPI_TX_EXT(index, i),
+			   FIELD_PREP(MAX96724_MIPI_TX_EXT_MAP_SRC_VC_H,
+				      remap->from_vc >> 2) |
+			   FIELD_PREP(MAX96724_MIPI_TX_EXT_MAP_DST_VC_H,
+				      remap->to_vc >> 2));
+	if (ret)
+		return ret;
+
 	/* Set destination PHY. */
 	return regmap_update_bits(priv->regmap, MAX96724_MIPI_TX45(index, i),
 				  MAX96724_MIPI_TX45_MAP_DPHY_DEST(i),
@@ -774,6 +849,21 @@ static int max96724_set_pipe_enable(struct max_des *des, struct max_des_pipe *pi
 				  MAX96724_VIDEO_PIPE_EN_MASK(index), enable);
 }
 
+static int max96724_set_pipes_enable(struct max_des *des, unsigned int mask,
+				     bool enable)
+{
+	struct max96724_priv *priv = des_to_priv(des);
+	unsigned int val = 0;
+	unsigned int i;
+
+	for (i = 0; i < des->ops->num_pipes; i++)
+		if (mask & BIT(i))
+			val |= MAX96724_VIDEO_PIPE_EN_MASK(i);
+
+	return regmap_assign_bits(priv->regmap, MAX96724_VIDEO_PIPE_EN, val,
+				  enable);
+}
+
 static int max96724_set_pipe_stream_id(struct max_des *des, struct max_des_pipe *pipe,
 				       unsigned int stream_id)
 {
@@ -898,6 +988,144 @@ static int max96724_set_link_version(struct max_des *des,
 				  field_prep(MAX96724_REG26_RX_RATE_PHY(index), val));
 }
 
+static int max96724_get_link_lock(struct max_des *des,
+				  struct max_des_link *link, bool *locked)
+{
+	struct max96724_priv *priv = des_to_priv(des);
+	unsigned int val;
+	int ret;
+
+	ret = regmap_read(priv->regmap, MAX96724_LINK_LOCK(link->index), &val);
+	if (ret)
+		return ret;
+
+	*locked = !!(val & MAX96724_LINK_LOCK_LOCKED);
+
+	return 0;
+}
+
+static int max96724_get_pipe_video_lock(struct max_des *des,
+					struct max_des_pipe *pipe, bool *locked)
+{
+	struct max96724_priv *priv = des_to_priv(des);
+	unsigned int val;
+	int ret;
+
+	ret = regmap_read(priv->regmap, MAX96724_VPRBS(pipe->index), &val);
+	if (ret)
+		return ret;
+
+	*locked = !!(val & MAX96724_VPRBS_VIDEO_LOCK);
+
+	return 0;
+}
+
+static int max96724_set_fsync(struct max_des *des,
+			      const struct max_des_fsync *fsync)
+{
+	struct max96724_priv *priv = des_to_priv(des);
+	u64 period;
+	u8 buf[3];
+	int ret;
+
+	if (!fsync->enable)
+		return regmap_update_bits(priv->regmap, MAX96724_FSYNC_0,
+					  MAX96724_FSYNC_0_FSYNC_MODE,
+					  FIELD_PREP(MAX96724_FSYNC_0_FSYNC_MODE,
+						     MAX96724_FSYNC_0_FSYNC_MODE_GEN_OFF));
+
+	/* The period is counted in crystal clock cycles. */
+	period = div_u64((u64)fsync->period_us * MAX96724_FSYNC_XTAL_HZ, USEC_PER_SEC);
+	if (!period || period > MAX96724_FSYNC_PERIOD_MAX)
+		return -ERANGE;
+
+	ret = regmap_write(priv->regmap, MAX96724_FSYNC_15,
+			   MAX96724_FSYNC_15_FS_GPIO_TYPE_GMSL2 |
+			   MAX96724_FSYNC_15_FS_USE_XTAL |
+			   field_prep(MAX96724_FSYNC_15_FS_LINK, fsync->links));
+	if (ret)
+		return ret;
+
+	ret = regmap_update_bits(priv->regmap, MAX96724_FSYNC_17,
+				 MAX96724_FSYNC_17_FSYNC_TX_ID,
+				 FIELD_PREP(MAX96724_FSYNC_17_FSYNC_TX_ID, fsync->tx_id));
+	if (ret)
+		return ret;
+
+	put_unaligned_le24(period, buf);
+
+	ret = regmap_bulk_write(priv->regmap, MAX96724_FSYNC_5, buf, sizeof(buf));
+	if (ret)
+		return ret;
+
+	/* Generation starts once the mode is set. */
+	return regmap_update_bits(priv->regmap, MAX96724_FSYNC_0,
+				  MAX96724_FSYNC_0_FSYNC_METH |
+				  MAX96724_FSYNC_0_FSYNC_MODE,
+				  FIELD_PREP(MAX96724_FSYNC_0_FSYNC_METH,
+					     MAX96724_FSYNC_0_FSYNC_METH_MANUAL) |
+				  FIELD_PREP(MAX96724_FSYNC_0_FSYNC_MODE,
+					     MAX96724_FSYNC_0_FSYNC_MODE_GEN_ON));
+}
+
+static int max96724_get_link_stats(struct max_des *des,
+				   struct max_des_link *link,
+				   struct max_des_link_stats *stats)
+{
+	struct max96724_priv *priv = des_to_priv(des);
+	unsigned int val;
+	int ret;
+
+	/* Error counters are cleared on read. */
+	ret = regmap_read(priv->regmap, MAX96724_CNT0(link->index), &val);
+	if (ret)
+		return ret;
+
+	stats->dec_err = val;
+
+	ret = regmap_read(priv->regmap, MAX96724_CNT4(link->index), &val);
+	if (ret)
+		return ret;
+
+	stats->idle_err = val;
+
+	return 0;
+}
+
+static int max96724_get_pipes_overflow(struct max_des *des,
+				       unsigned long *pipes)
+{
+	struct max96724_priv *priv = des_to_priv(des);
+	unsigned int val, i;
+	int ret;
+
+	*pipes = 0;
+
+	/* Overflow flags are latched until read, read each bank once. */
+	for (i = 0; i < des->ops->num_pipes; i++) {
+		if (i % 4 == 0) {
+			ret = regmap_read(priv->regmap, MAX96724_BACKTOP11(i), &val);
+			if (ret)
+				return ret;
+		}
+
+		if (val & (MAX96724_BACKTOP11_LMO(i) |
+			   MAX96724_BACKTOP11_CMD_OVERFLOW(i)))
+			*pipes |= BIT(i);
+	}
+
+	return 0;
+}
+
+static int max96724_reset_link(struct max_des *des, struct max_des_link *link)
+{
+	struct max96724_priv *priv = des_to_priv(des);
+
+	return regmap_set_bits(priv->regmap, MAX96724_CTRL1,
+			       field_prep(MAX96724_CTRL1_RESET_ONESHOT,
+					  BIT(link->index)));
+}
+
 static int max96724_set_tpg_timings(struct max96724_priv *priv,
 				    const struct max_serdes_tpg_timings *tm)
 {
@@ -934,6 +1162,7 @@ static int max96724_set_tpg_timings(struct max96724_priv *priv,
 static int max96724_set_tpg_clk(struct max96724_priv *priv, u32 clock)
 {
 	bool patgen_clk_src = 0;
+	unsigned int i;
 	u8 pclk_src;
 	int ret;
 
@@ -958,16 +1187,15 @@ static int max96724_set_tpg_clk(struct max96724_priv *priv, u32 clock)
 		return -EINVAL;
 	}
 
-	/*
-	 * TPG data is always injected on link 0, which is always routed to
-	 * pipe 0.
-	 */
-	ret = regmap_update_bits(priv->regmap, MAX96724_VPRBS(0),
-				 MAX96724_VPRBS_PATGEN_CLK_SRC,
-				 FIELD_PREP(MAX96724_VPRBS_PATGEN_CLK_SRC,
-					    patgen_clk_src));
-	if (ret)
-		return ret;
+	/* TPG data is injected into all pipes, clock them all the same. */
+	for (i = 0; i < priv->des.ops->num_pipes; i++) {
+		ret = regmap_update_bits(priv->regmap, MAX96724_VPRBS(i),
+					 MAX96724_VPRBS_PATGEN_CLK_SRC,
+					 FIELD_PREP(MAX96724_VPRBS_PATGEN_CLK_SRC,
+						    patgen_clk_src));
+		if (ret)
+			return ret;
+	}
 
 	return regmap_update_bits(priv->regmap, MAX96724_DEBUG_EXTRA,
 				  MAX96724_DEBUG_EXTRA_PCLK_SRC,
@@ -1028,12 +1256,15 @@ static const struct max_serdes_tpg_entry max96724_tpg_entries[] = {
 	MAX_TPG_ENTRY_640X480P60_RGB888,
 	MAX_TPG_ENTRY_1920X1080P30_RGB888,
 	MAX_TPG_ENTRY_1920X1080P60_RGB888,
+	MAX_TPG_ENTRY_1920X1080P120_RGB888,
+	MAX_TPG_ENTRY_3840X2160P30_RGB888,
 };
 
 static const struct max_des_ops max96724_ops = {
 	.num_phys = 4,
 	.num_links = 4,
 	.num_remaps_per_pipe = 16,
+	.num_vc_ids = MAX_SERDES_VCX_ID_NUM_CPHY,
 	.phys_configs = {
 		.num_configs = ARRAY_SIZE(max96724_phys_configs),
 		.configs = max96724_phys_configs,
@@ -1060,12 +1291,20 @@ static const struct max_des_ops max96724_ops = {
 	.set_pipe_stream_id = max96724_set_pipe_stream_id,
 	.set_pipe_link = max96724_set_pipe_link,
 	.set_pipe_enable = max96724_set_pipe_enable,
+	.set_pipes_enable = max96724_set_pipes_enable,
 	.set_pipe_remap = max96724_set_pipe_remap,
 	.set_pipe_remaps_enable = max96724_set_pipe_remaps_enable,
 	.set_pipe_mode = max96724_set_pipe_mode,
 	.set_tpg = max96724_set_tpg,
 	.select_links = max96724_select_links,
 	.set_link_version = max96724_set_link_version,
+	.get_link_lock = max96724_get_link_lock,
+	.get_pipe_video_lock = max96724_get_pipe_video_lock,
+	.reset_link = max96724_reset_link,
+	.get_link_stats = max96724_get_link_stats,
+	.get_phy_stats = max96724_get_phy_stats,
+	.get_pipes_overflow = max96724_get_pipes_overflow,
+	.set_fsync = max96724_set_fsync,
 };
 
 static const struct max96724_chip_info max96724_info = {
@@ -1113,7 +1352,7 @@ static int max96724_probe(struct i2c_client *client)
 	if (!ops)
 		return -ENOMEM;
 
-	priv->info = device_get_match_data(dev);
+	priv->info = i2c_get_match_data(client);
 	if (!priv->info) {
 		dev_err(dev, "Failed to get match data\n");
 		return -ENODEV;
@@ -1184,6 +1423,15 @@ static const struct of_device_id max96724_of_table[] = {
 };
 MODULE_DEVICE_TABLE(of, max96724_of_table);
 
+static const struct i2c_device_id max96724_i2c_ids[] = {
+	{ "max96712", (kernel_ulong_t)&max96712_info },
+	{ "max96724", (kernel_ulong_t)&max96724_info },
+	{ "max96724f", (kernel_ulong_t)&max96724f_info },
+	{ "max96724r", (kernel_ulong_t)&max96724f_info },
+	{ },
+};
+MODULE_DEVICE_TABLE(i2c, max96724_i2c_ids);
+
 static struct i2c_driver max96724_i2c_driver = {
 	.driver	= {
 		.name = "max96724",
@@ -1192,6 +1440,7 @@ static struct i2c_driver max96724_i2c_driver = {
 	},
 	.probe = max96724_probe,
 	.remove = max96724_remove,
+	.id_table = max96724_i2c_ids,
 };
 
 module_i2c_driver(max96724_i2c_driver);
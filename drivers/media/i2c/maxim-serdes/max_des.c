@@ -7,13 +7,19 @@
 
 #include <linux/delay.h>
 #include <linux/acpi.h>
+#include <linux/debugfs.h>
 #include <linux/i2c-atr.h>
 #include <linux/i2c-mux.h>
+#include <linux/iopoll.h>
 #include <linux/module.h>
+#include <linux/mutex.h>
 #include <linux/regulator/consumer.h>
+#include <linux/seq_file.h>
+#include <linux/workqueue.h>
 
 #include <media/mipi-csi2.h>
 #include <media/v4l2-ctrls.h>
+#include <media/v4l2-event.h>
 #include <media/v4l2-fwnode.h>
 #include <media/v4l2-subdev.h>
 
@@ -24,11 +30,70 @@
 #define MAX_DES_LINK_FREQUENCY_MIN		100000000ull
 #define MAX_DES_LINK_FREQUENCY_DEFAULT		750000000ull
 #define MAX_DES_LINK_FREQUENCY_MAX		1250000000ull
+#define MAX_DES_LINK_FREQUENCY_STEP		50000000ull
+#define MAX_DES_NUM_LINK_FREQUENCIES \
+	((MAX_DES_LINK_FREQUENCY_MAX - MAX_DES_LINK_FREQUENCY_MIN + \
+	  MAX_DES_LINK_FREQUENCY_STEP - 1) / MAX_DES_LINK_FREQUENCY_STEP + 1)
+
+/* Margin for CSI-2 packet headers, footers and LP transitions. */
+#define MAX_DES_CSI2_OVERHEAD_PERCENT		10
 
 #define MAX_DES_NUM_PHYS			4
 #define MAX_DES_NUM_LINKS			4
 #define MAX_DES_NUM_PIPES			8
 
+#define MAX_DES_LINK_LOCK_POLL_US		1000
+#define MAX_DES_LINK_LOCK_TIMEOUT_US		100000
+#define MAX_DES_SER_RESET_US			10000
+#define MAX_DES_LINK_MONITOR_MS			100
+#define MAX_DES_START_SKEW_POLL_US		500
+#define MAX_DES_START_SKEW_TIMEOUT_US		200000
+
+#define MAX_DES_FSYNC_PERIOD_MAX_US		500000
+#define MAX_DES_FSYNC_TX_ID_NONE		U32_MAX
+
+#define MAX_DES_TELEMETRY_RECORDS		256
+#define MAX_DES_TELEMETRY_INTERVAL_MS		1000
+#define MAX_DES_TELEMETRY_INTERVAL_MIN_MS	100
+
+struct max_des_bw {
+	u64 links[MAX_DES_NUM_LINKS];
+	u64 pipes[MAX_DES_NUM_PIPES];
+	u64 phys[MAX_DES_NUM_PHYS];
+	/* PHYs carrying streams whose bandwidth could not be estimated. */
+	unsigned long unaccounted_phys;
+};
+
+enum max_des_fsync_mode {
+	MAX_DES_FSYNC_MODE_DISABLED,
+	MAX_DES_FSYNC_MODE_CONTINUOUS,
+	MAX_DES_FSYNC_MODE_SYNC_START,
+};
+
+static const char * const max_des_fsync_modes[] = {
+	[MAX_DES_FSYNC_MODE_DISABLED] = "Disabled",
+	[MAX_DES_FSYNC_MODE_CONTINUOUS] = "Continuous",
+	[MAX_DES_FSYNC_MODE_SYNC_START] = "Synchronized Start",
+};
+
+/*
+ * Telemetry sample, exported as-is through the telemetry debugfs file.
+ * Error counters are cumulative since streaming started, packet counters
+ * are the raw hardware values. Pipe overflows are the pipes whose line
+ * memory overflowed since the previous sample.
+ */
+struct max_des_telemetry_record {
+	u64 timestamp_ns;
+	u32 link_dec_err[MAX_DES_NUM_LINKS];
+	u32 link_idle_err[MAX_DES_NUM_LINKS];
+	u32 phy_csi2_pkt_cnt[MAX_DES_NUM_PHYS];
+	u32 phy_pkt_cnt[MAX_DES_NUM_PHYS];
+	u8 link_locked;
+	u8 pipe_video_locked;
+	u8 pipe_overflow;
+	u8 reserved[5];
+} __packed;
+
 struct max_des_priv {
 	struct max_des *des;
 
@@ -47,15 +112,100 @@ struct max_des_priv {
 	struct v4l2_async_notifier nf;
 	struct v4l2_ctrl_handler ctrl_handler;
 	struct v4l2_ctrl *link_freq_ctrl;
-	s64 link_freq_menu[1];
+	struct max_des_phy *link_freq_phy;
+	s64 link_freq_menu[MAX_DES_NUM_LINK_FREQUENCIES];
+	unsigned int num_link_freqs;
+
+	/* Link frequencies from firmware, used as the upper limit. */
+	u64 phys_max_link_frequency[MAX_DES_NUM_PHYS];
+	/* Link frequencies the PHYs are currently programmed with. */
+	u64 phys_link_frequency_applied[MAX_DES_NUM_PHYS];
 
 	struct max_des_phy *unused_phy;
+
+	/* Links whose serializer has already been reset in parallel. */
+	unsigned long ser_reset_links;
+	/*
+	 * Links whose serializer is attached. In I2C mux mode, the serializer
+	 * translation of a detached link is kept in link->ser_xlate, to be
+	 * reused on attach.
+	 */
+	unsigned long ser_bound_links;
+
+	/*
+	 * Whether the pipe to PHY mapping and tunnel settings in des->pipes
+	 * and des->mode match the hardware, in which case they are only
+	 * rewritten when they change. Cleared whenever the hardware may have
+	 * diverged: on init, on link recovery and on write errors.
+	 */
+	bool pipes_phy_applied;
+	bool tunnel_applied;
+
+	/* Estimated bandwidth used by the currently enabled streams, in bps. */
+	struct max_des_bw bw;
+	struct dentry *debugfs;
+
+	/*
+	 * While streaming, links are polled for link and video lock. Links
+	 * which have been seen healthy and then lose lock are marked as lost
+	 * until they have been recovered.
+	 */
+	struct delayed_work link_monitor;
+	unsigned long healthy_links;
+	unsigned long lost_links;
+
+	/*
+	 * While streaming, error counters are sampled every
+	 * telemetry_interval_ms into a ring of telemetry records.
+	 */
+	struct delayed_work telemetry_work;
+	struct mutex telemetry_lock;
+	struct max_des_telemetry_record *telemetry;
+	struct max_des_telemetry_record telemetry_last;
+	unsigned int telemetry_head;
+	unsigned int telemetry_count;
+	u32 telemetry_interval_ms;
+	bool telemetry_running;
+
+	/*
+	 * Frame sync is sent to the serializers as GPIO tx_id. In synchronized
+	 * start mode, it is only armed once all routed links are streaming.
+	 * Protected by the control handler lock.
+	 */
+	struct v4l2_ctrl *fsync_mode_ctrl;
+	struct v4l2_ctrl *fsync_period_ctrl;
+	struct max_des_fsync fsync;
+	u32 fsync_tx_id;
+	bool fsync_armed;
+
+	/*
+	 * In grouped start mode, pipes are configured but held disabled until
+	 * every routed stream is enabled, then released together, after all
+	 * sensors have been started.
+	 */
+	struct v4l2_ctrl *grouped_start_ctrl;
+	bool grouped_start;
+	unsigned long held_pipes;
+
+	/*
+	 * Time from the last grouped release to video lock, per pipe. Polled
+	 * from start_skew_work, outside of the subdev state lock.
+	 */
+	struct delayed_work start_skew_work;
+	struct mutex start_skew_lock;
+	ktime_t start_release;
+	unsigned long start_pending_pipes;
+	unsigned long start_locked_pipes;
+	s64 start_lock_us[MAX_DES_NUM_PIPES];
+	s64 start_skew_us;
 };
 
 struct max_des_remap_context {
 	enum max_serdes_gmsl_mode mode;
 	/* Mark whether TPG is enabled */
 	bool tpg;
+	/* Mark whether a sink stream is replicated to multiple PHYs. */
+	bool replicated;
 	/* Mark the PHYs to which each pipe is mapped. */
 	unsigned long pipe_phy_masks[MAX_DES_NUM_PIPES];
 	/* Mark the pipes in use. */
@@ -63,7 +213,7 @@ struct max_des_remap_context {
 	/* Mark whether pipe has remapped VC ids. */
 	bool vc_ids_remapped[MAX_DES_NUM_PIPES];
 	/* Map between pipe VC ids and PHY VC ids. */
-	unsigned int vc_ids_map[MAX_DES_NUM_PIPES][MAX_DES_NUM_PHYS][MAX_SERDES_VC_ID_NUM];
+	u8 vc_ids_map[MAX_DES_NUM_PIPES][MAX_DES_NUM_PHYS][MAX_SERDES_VCX_ID_NUM_CPHY];
 	/* Mark whether a pipe VC id has been mapped to a PHY VC id. */
 	unsigned long vc_ids_masks[MAX_DES_NUM_PIPES][MAX_DES_NUM_PHYS];
 	/* Mark whether a PHY VC id has been mapped. */
@@ -287,7 +437,7 @@ max_des_find_state_tpg_entry(struct max_des *des, struct v4l2_subdev_state *stat
 static int max_des_get_tpg_fd_entry_state(struct max_des *des,
 					  struct v4l2_subdev_state *state,
 					  struct v4l2_mbus_frame_desc_entry *fd_entry,
-					  unsigned int pad)
+					  unsigned int pad, unsigned int stream)
 {
 	const struct max_serdes_tpg_entry *entry;
 
@@ -295,7 +445,7 @@ static int max_des_get_tpg_fd_entry_state(struct max_des *des,
 	if (!entry)
 		return -EINVAL;
 
-	fd_entry->stream = MAX_SERDES_TPG_STREAM;
+	fd_entry->stream = stream;
 	fd_entry->flags = V4L2_MBUS_FRAME_DESC_FL_LEN_MAX;
 	fd_entry->length = entry->width * entry->height * entry->bpp / 8;
 	fd_entry->pixelcode = entry->code;
@@ -312,15 +462,18 @@ static int max_des_tpg_route_to_hw(struct max_des_priv *priv,
 {
 	struct max_des *des = priv->des;
 
-	/* TPG injects its data into all pipes, but use pipe 0 for simplicity. */
-	hw->pipe = &des->pipes[0];
+	/*
+	 * TPG injects its data into all pipes, each TPG stream is carried by
+	 * the pipe matching its index.
+	 */
+	hw->pipe = &des->pipes[route->sink_stream];
 
 	hw->phy = max_des_pad_to_phy(des, route->source_pad);
 	if (!hw->phy)
 		return -ENOENT;
 
 	return max_des_get_tpg_fd_entry_state(des, state, &hw->entry,
-					      route->sink_pad);
+					      route->sink_pad, route->sink_stream);
 }
 
 static int max_des_route_to_hw(struct max_des_priv *priv,
@@ -469,13 +622,35 @@ static int max_des_set_pipe_vc_remaps(struct max_des_priv *priv,
 	return des->ops->set_pipe_vc_remaps_enable(des, pipe, mask);
 }
 
-static int max_des_map_src_dst_vc_id(struct max_des_remap_context *context,
+static unsigned int max_des_num_vc_ids(struct max_des *des)
+{
+	return des->ops->num_vc_ids ?: MAX_SERDES_VC_ID_NUM;
+}
+
+static unsigned int max_des_phy_num_vc_ids(struct max_des *des,
+					   struct max_des_phy *phy)
+{
+	unsigned int num_vc_ids = max_des_num_vc_ids(des);
+
+	/*
+	 * CSI-2 VCX extends the VC with 2 more bits on D-PHY, and 3 more
+	 * bits on C-PHY.
+	 */
+	if (phy->bus_type == V4L2_MBUS_CSI2_DPHY)
+		num_vc_ids = min(num_vc_ids, MAX_SERDES_VCX_ID_NUM_DPHY);
+
+	return num_vc_ids;
+}
+
+static int max_des_map_src_dst_vc_id(struct max_des *des,
+				     struct max_des_remap_context *context,
 				     unsigned int pipe_id, unsigned int phy_id,
 				     unsigned int src_vc_id, bool keep_vc)
 {
+	unsigned int num_vc_ids = max_des_phy_num_vc_ids(des, &des->phys[phy_id]);
 	unsigned int vc_id;
 
-	if (src_vc_id >= MAX_SERDES_VC_ID_NUM)
+	if (src_vc_id >= max_des_num_vc_ids(des))
 		return -E2BIG;
 
 	if (context->vc_ids_masks[pipe_id][phy_id] & BIT(src_vc_id))
@@ -489,7 +664,7 @@ static int max_des_map_src_dst_vc_id(struct max_des_remap_context *context,
 	if (vc_id != src_vc_id)
 		context->vc_ids_remapped[pipe_id] = true;
 
-	if (vc_id >= MAX_SERDES_VC_ID_NUM)
+	if (vc_id >= num_vc_ids)
 		return -E2BIG;
 
 	context->pipe_phy_masks[pipe_id] |= BIT(phy_id);
@@ -513,6 +688,24 @@ static int max_des_get_src_dst_vc_id(struct max_des_remap_context *context,
 	return 0;
 }
 
+/* Whether an earlier route already carries the same sink stream. */
+static bool max_des_route_is_replica(const struct v4l2_subdev_krouting *routing,
+				     const struct v4l2_subdev_route *route)
+{
+	struct v4l2_subdev_route *other;
+
+	for_each_active_route(routing, other) {
+		if (other == route)
+			return false;
+
+		if (other->sink_pad == route->sink_pad &&
+		    other->sink_stream == route->sink_stream)
+			return true;
+	}
+
+	return false;
+}
+
 static int max_des_populate_remap_usage(struct max_des_priv *priv,
 					struct max_des_remap_context *context,
 					struct v4l2_subdev_state *state)
@@ -530,6 +723,9 @@ static int max_des_populate_remap_usage(struct max_des_priv *priv,
 		if (hw.is_tpg)
 			context->tpg = true;
 
+		if (max_des_route_is_replica(&state->routing, route))
+			context->replicated = true;
+
 		context->pipe_in_use[hw.pipe->index] = true;
 	}
 
@@ -549,6 +745,10 @@ static int max_des_get_supported_modes(struct max_des_priv *priv,
 	if (context->tpg)
 		*modes = BIT(des->ops->tpg_mode);
 
+	/* Only pixel mode remaps can send a pipe to multiple PHYs. */
+	if (context->replicated)
+		*modes &= BIT(MAX_SERDES_GMSL_PIXEL_MODE);
+
 	for (i = 0; i < des->ops->num_links; i++) {
 		struct max_des_link_hw hw;
 
@@ -677,8 +877,9 @@ static int max_des_populate_remap_context(struct max_des_priv *priv,
 
 		keep_vc = max_des_should_keep_vc(priv, &hw, modes);
 
-		ret = max_des_map_src_dst_vc_id(context, hw.pipe->index, hw.phy->index,
-						hw.entry.bus.csi2.vc, keep_vc);
+		ret = max_des_map_src_dst_vc_id(priv->des, context, hw.pipe->index,
+						hw.phy->index, hw.entry.bus.csi2.vc,
+						keep_vc);
 		if (ret)
 			return ret;
 	}
@@ -686,46 +887,143 @@ static int max_des_populate_remap_context(struct max_des_priv *priv,
 	return max_des_populate_remap_context_mode(priv, context, modes);
 }
 
+static int max_des_get_route_bps(struct max_des_priv *priv,
+				 struct v4l2_subdev_state *state,
+				 struct v4l2_subdev_route *route,
+				 struct max_des_route_hw *hw, u64 *bps)
+{
+	struct max_des *des = priv->des;
+	unsigned int bpp;
+	u64 pixel_rate;
+	int ret;
+
+	*bps = 0;
+
+	/* Embedded data only takes a few lines, don't account for it. */
+	if (hw->entry.bus.csi2.dt == MIPI_CSI2_DT_EMBEDDED_8B)
+		return 0;
+
+	/* Tunnel mode can carry data types unknown to us. */
+	if (max_serdes_get_fd_bpp(&hw->entry, &bpp))
+		return 0;
+
+	if (hw->is_tpg) {
+		const struct max_serdes_tpg_entry *entry;
+		struct max_serdes_tpg_timings timings = { 0 };
+
+		entry = max_des_find_state_tpg_entry(des, state, route->sink_pad);
+
+		ret = max_serdes_get_tpg_timings(entry, &timings);
+		if (ret)
+			return ret;
+
+		pixel_rate = timings.clock;
+	} else {
+		if (!hw->source->sd)
+			return 0;
+
+		/*
+		 * The pixel rate includes blanking, which makes this an upper
+		 * bound. Sensors not reporting it cannot be accounted for.
+		 */
+		ret = max_serdes_get_pixel_rate(hw->source->sd, &pixel_rate);
+		if (ret == -ENOENT)
+			return 0;
+		if (ret)
+			return ret;
+	}
+
+	*bps = pixel_rate * bpp;
+
+	return 0;
+}
+
+/*
+ * Pixel rate of each bpp carried by a pipe, used to weigh the link usage of
+ * doubling. Embedded data only takes a few lines and weighs nothing. Weigh
+ * every bpp the same if the rate of any other stream is unknown.
+ */
+static int max_des_get_pipe_bpp_rates(struct max_des_priv *priv,
+				      struct v4l2_subdev_state *state,
+				      struct max_des_pipe *pipe, u64 *rates)
+{
+	struct v4l2_subdev_route *route;
+	bool unknown = false;
+	unsigned int bpp;
+	int ret;
+
+	memset(rates, 0, sizeof(*rates) * MAX_SERDES_NUM_BPPS);
+
+	for_each_active_route(&state->routing, route) {
+		struct max_des_route_hw hw;
+		u64 bps;
+
+		ret = max_des_route_to_hw(priv, state, route, &hw);
+		if (ret)
+			return ret;
+
+		if (hw.pipe != pipe ||
+		    max_des_route_is_replica(&state->routing, route))
+			continue;
+
+		ret = max_serdes_get_fd_bpp(&hw.entry, &bpp);
+		if (ret)
+			return ret;
+
+		ret = max_des_get_route_bps(priv, state, route, &hw, &bps);
+		if (ret)
+			return ret;
+
+		if (!bps && hw.entry.bus.csi2.dt != MIPI_CSI2_DT_EMBEDDED_8B)
+			unknown = true;
+
+		rates[bpp] += div_u64(bps, bpp);
+	}
+
+	if (unknown)
+		for (bpp = 0; bpp < MAX_SERDES_NUM_BPPS; bpp++)
+			rates[bpp] = 1;
+
+	return 0;
+}
+
 static int max_des_populate_mode_context(struct max_des_priv *priv,
 					 struct max_des_mode_context *context,
 					 struct v4l2_subdev_state *state,
 					 enum max_serdes_gmsl_mode mode)
 {
 	bool bpp8_not_shared_with_16_phys[MAX_DES_NUM_PHYS] = { 0 };
+	unsigned int doubled_bpps_pipes[MAX_DES_NUM_PIPES] = { 0 };
 	u32 undoubled_bpps_phys[MAX_DES_NUM_PHYS] = { 0 };
+	unsigned long phys_pipes[MAX_DES_NUM_PIPES] = { 0 };
 	u32 bpps_pipes[MAX_DES_NUM_PIPES] = { 0 };
+	u64 rates[MAX_SERDES_NUM_BPPS];
 	struct max_des *des = priv->des;
 	struct v4l2_subdev_route *route;
-	unsigned int i;
+	unsigned int i, phy_id;
 	int ret;
 
 	if (mode != MAX_SERDES_GMSL_PIXEL_MODE)
 		return 0;
 
 	/*
-	 * Go over all streams and gather the bpps for all pipes.
+	 * Doubling is configured per PHY, so all the pipes streaming a bpp to
+	 * a PHY have to agree on whether it is doubled.
 	 *
-	 * Then, go over all the streams again and check if the
-	 * current stream is doubled.
+	 * Go over all streams and gather the bpps of all pipes, and the PHYs
+	 * each pipe streams to.
 	 *
-	 * If the current stream is doubled, add it to a doubled mask for both
-	 * the pipe and the PHY.
+	 * Then, let each pipe pick the bpp to double which puts the fewest
+	 * bits on the link, weighed by the pixel rates of its streams.
 	 *
-	 * If the current stream is not doubled, add it to a local undoubled
-	 * mask for the PHY.
+	 * A bpp left undoubled by any pipe cannot be doubled on the PHYs that
+	 * pipe streams to, so pick again without it for the pipes which
+	 * doubled it. A pipe only ever doubles its lowest bpp, which is then
+	 * already undoubled on its PHYs, so a single pass is enough. A pipe
+	 * which cannot stream its bpps undoubled makes the routing fail.
 	 *
-	 * Also, track whether an 8bpp stream is shared with any bpp > 8 on both
+	 * Last, track whether an 8bpp stream is shared with any bpp > 8 on both
 	 * the PHYs and the pipes, since that needs to be special cased.
-	 *
-	 * After going over all the streams, remove the undoubled streams from
-	 * the doubled ones. Doubled and undoubled streams cannot be streamed
-	 * over the same PHY.
-	 *
-	 * Then, do a second pass to remove the undoubled streams from the pipes.
-	 *
-	 * This operation cannot be done in a single pass because any pipe might
-	 * generate an undoubled stream for a specific bpp, causing already
-	 * processed pipes to need to have their doubled bpps updated.
 	 */
 
 	for_each_active_route(&state->routing, route) {
@@ -741,44 +1039,78 @@ static int max_des_populate_mode_context(struct max_des_priv *priv,
 			return ret;
 
 		bpps_pipes[hw.pipe->index] |= BIT(bpp);
+		__set_bit(hw.phy->index, &phys_pipes[hw.pipe->index]);
 	}
 
-	for_each_active_route(&state->routing, route) {
-		unsigned int bpp, min_bpp, max_bpp, doubled_bpp;
-		unsigned int pipe_id, phy_id;
-		struct max_des_route_hw hw;
-		u32 sink_bpps;
+	for (i = 0; i < des->ops->num_pipes; i++) {
+		if (!bpps_pipes[i])
+			continue;
 
-		ret = max_des_route_to_hw(priv, state, route, &hw);
+		ret = max_des_get_pipe_bpp_rates(priv, state, &des->pipes[i],
+						 rates);
 		if (ret)
 			return ret;
 
-		ret = max_serdes_get_fd_bpp(&hw.entry, &bpp);
+		ret = max_serdes_process_bpps(priv->dev, bpps_pipes[i], ~0U, rates,
+					      &doubled_bpps_pipes[i]);
 		if (ret)
 			return ret;
 
-		sink_bpps = bpps_pipes[hw.pipe->index];
+		for_each_set_bit(phy_id, &phys_pipes[i], MAX_DES_NUM_PHYS)
+			undoubled_bpps_phys[phy_id] |= bpps_pipes[i] &
+						       ~BIT(doubled_bpps_pipes[i]);
+	}
+
+	for (i = 0; i < des->ops->num_pipes; i++) {
+		u32 allowed_double_bpps = ~0U;
+
+		if (!doubled_bpps_pipes[i])
+			continue;
+
+		for_each_set_bit(phy_id, &phys_pipes[i], MAX_DES_NUM_PHYS)
+			allowed_double_bpps &= ~undoubled_bpps_phys[phy_id];
+
+		if (allowed_double_bpps & BIT(doubled_bpps_pipes[i]))
+			continue;
+
+		ret = max_serdes_process_bpps(priv->dev, bpps_pipes[i],
+					      allowed_double_bpps, NULL,
+					      &doubled_bpps_pipes[i]);
+		if (ret) {
+			dev_err(priv->dev,
+				"Pipe %u needs %ubpp doubled, shared undoubled on its PHYs\n",
+				i, __ffs(bpps_pipes[i]));
+			return ret;
+		}
+	}
+
+	for_each_active_route(&state->routing, route) {
+		unsigned int bpp, max_bpp, doubled_bpp;
+		unsigned int pipe_id;
+		struct max_des_route_hw hw;
+
+		ret = max_des_route_to_hw(priv, state, route, &hw);
+		if (ret)
+			return ret;
 
-		ret = max_serdes_process_bpps(priv->dev, sink_bpps, ~0U, &doubled_bpp);
+		ret = max_serdes_get_fd_bpp(&hw.entry, &bpp);
 		if (ret)
 			return ret;
 
-		min_bpp = __ffs(sink_bpps);
-		max_bpp = __fls(sink_bpps);
 		pipe_id = hw.pipe->index;
 		phy_id = hw.phy->index;
+		doubled_bpp = doubled_bpps_pipes[pipe_id];
+		max_bpp = __fls(bpps_pipes[pipe_id]);
 
 		if (bpp == doubled_bpp) {
 			context->phys_double_bpps[phy_id] |= BIT(bpp);
 			context->pipes_double_bpps[pipe_id] |= BIT(bpp);
-		} else {
-			undoubled_bpps_phys[phy_id] |= BIT(bpp);
 		}
 
-		if (min_bpp == 8 && max_bpp > 8) {
+		if (doubled_bpp == 8 && max_bpp > 8) {
 			context->phys_bpp8_shared_with_16[phy_id] = true;
 			context->pipes_bpp8_shared_with_16[pipe_id] = true;
-		} else if (min_bpp == 8 && max_bpp == 8) {
+		} else if (doubled_bpp == 8 && max_bpp == 8) {
 			bpp8_not_shared_with_16_phys[phy_id] = true;
 		}
 	}
@@ -792,20 +1124,6 @@ static int max_des_populate_mode_context(struct max_des_priv *priv,
 		}
 	}
 
-	for (i = 0; i < des->ops->num_phys; i++)
-		context->phys_double_bpps[i] &= ~undoubled_bpps_phys[i];
-
-	for_each_active_route(&state->routing, route) {
-		struct max_des_route_hw hw;
-
-		ret = max_des_route_to_hw(priv, state, route, &hw);
-		if (ret)
-			return ret;
-
-		context->pipes_double_bpps[hw.pipe->index] &=
-			context->phys_double_bpps[hw.phy->index];
-	}
-
 	return 0;
 }
 
@@ -1007,14 +1325,17 @@ static int max_des_set_tunnel(struct max_des_priv *priv,
 	unsigned int i;
 	int ret;
 
-	if (des->ops->set_pipe_tunnel_enable) {
+	if (des->ops->set_pipe_tunnel_enable &&
+	    (!priv->tunnel_applied || des->mode != context->mode)) {
 		for (i = 0; i < des->ops->num_pipes; i++) {
 			struct max_des_pipe *pipe = &des->pipes[i];
 			bool tunnel_mode = context->mode == MAX_SERDES_GMSL_TUNNEL_MODE;
 
 			ret = des->ops->set_pipe_tunnel_enable(des, pipe, tunnel_mode);
-			if (ret)
+			if (ret) {
+				priv->tunnel_applied = false;
 				return ret;
+			}
 		}
 	}
 
@@ -1043,6 +1364,7 @@ static int max_des_set_tunnel(struct max_des_priv *priv,
 	}
 
 	des->mode = context->mode;
+	priv->tunnel_applied = true;
 
 	return 0;
 }
@@ -1137,11 +1459,15 @@ static int max_des_set_pipes_stream_id(struct max_des_priv *priv)
 			return -EINVAL;
 		}
 
+		stream_id_usage[stream_id] = true;
+
+		if (hw.pipe->stream_id == stream_id)
+			continue;
+
 		ret = des->ops->set_pipe_stream_id(des, hw.pipe, stream_id);
 		if (ret)
 			return ret;
 
-		stream_id_usage[stream_id] = true;
 		hw.pipe->stream_id = stream_id;
 	}
 
@@ -1171,6 +1497,10 @@ static int max_des_set_pipes_phy(struct max_des_priv *priv,
 		     phy_id == des->ops->num_phys))
 			phy_id = priv->unused_phy->index;
 
+		if (priv->pipes_phy_applied && des->mode == context->mode &&
+		    pipe->phy_id == phy_id)
+			continue;
+
 		if (phy_id != des->ops->num_phys) {
 			phy = &des->phys[phy_id];
 
@@ -1183,13 +1513,17 @@ static int max_des_set_pipes_phy(struct max_des_priv *priv,
 			else
 				ret = 0;
 
-			if (ret)
+			if (ret) {
+				priv->pipes_phy_applied = false;
 				return ret;
+			}
 		}
 
 		pipe->phy_id = phy_id;
 	}
 
+	priv->pipes_phy_applied = true;
+
 	return 0;
 }
 
@@ -1261,7 +1595,8 @@ static int max_des_get_pipe_remaps(struct max_des_priv *priv,
 	struct v4l2_mbus_frame_desc_entry tpg_entry = { 0 };
 	struct max_des *des = priv->des;
 	struct v4l2_subdev_route *route;
-	bool is_tpg_pipe = true;
+	bool is_tpg_pipe = false;
+	bool has_tpg = false;
 	int ret;
 
 	*num_remaps = 0;
@@ -1273,16 +1608,20 @@ static int max_des_get_pipe_remaps(struct max_des_priv *priv,
 		struct max_des_route_hw hw;
 		unsigned int src_vc_id, dst_vc_id;
 
-		if (!(BIT_ULL(route->sink_stream) & streams_masks[route->sink_pad]))
+		/* Replicas only reach their PHY once their own stream is enabled. */
+		if (!(BIT_ULL(route->source_stream) & streams_masks[route->source_pad]))
 			continue;
 
 		ret = max_des_route_to_hw(priv, state, route, &hw);
 		if (ret)
 			return ret;
 
-		if (hw.is_tpg && hw.pipe != pipe) {
-			is_tpg_pipe = false;
+		if (hw.is_tpg) {
+			has_tpg = true;
 			tpg_entry = hw.entry;
+
+			if (hw.pipe == pipe)
+				is_tpg_pipe = true;
 		}
 
 		if (hw.pipe != pipe)
@@ -1303,15 +1642,15 @@ static int max_des_get_pipe_remaps(struct max_des_priv *priv,
 	}
 
 	/*
-	 * TPG mode is only handled on pipe 0, but the TPG pollutes other pipes
-	 * with the same data.
+	 * TPG mode is only handled on the pipes carrying TPG streams, but the
+	 * TPG pollutes other pipes with the same data.
 	 * For devices that do not support setting the default PHY of a pipe,
 	 * we want to filter out this data so it does not end up on the wrong
 	 * PHY.
 	 * Devices that support setting the default PHY of a pipe already use it
 	 * to route unused pipes to an unused PHY.
 	 */
-	if (context->tpg && !is_tpg_pipe && !des->ops->set_pipe_phy &&
+	if (has_tpg && !is_tpg_pipe && !des->ops->set_pipe_phy &&
 	    priv->unused_phy) {
 		ret = max_des_add_remaps(des, remaps, num_remaps,
 					 priv->unused_phy->index,
@@ -1349,6 +1688,14 @@ static int max_des_update_pipe_vc_remaps(struct max_des_priv *priv,
 	if (ret)
 		goto err_free_new_vc_remaps;
 
+	/* Leave pipes which are already streaming undisturbed. */
+	if (num_vc_remaps == pipe->num_vc_remaps &&
+	    (!num_vc_remaps ||
+	     !memcmp(pipe->vc_remaps, vc_remaps, num_vc_remaps * sizeof(*vc_remaps)))) {
+		devm_kfree(priv->dev, vc_remaps);
+		return 0;
+	}
+
 	ret = max_des_set_pipe_vc_remaps(priv, pipe, vc_remaps, num_vc_remaps);
 	if (ret)
 		goto err_free_new_vc_remaps;
@@ -1391,6 +1738,14 @@ static int max_des_update_pipe_remaps(struct max_des_priv *priv,
 	if (ret)
 		goto err_free_new_remaps;
 
+	/* Leave pipes which are already streaming undisturbed. */
+	if (num_remaps == pipe->num_remaps &&
+	    (!num_remaps ||
+	     !memcmp(pipe->remaps, remaps, num_remaps * sizeof(*remaps)))) {
+		devm_kfree(priv->dev, remaps);
+		return 0;
+	}
+
 	ret = max_des_set_pipe_remaps(priv, pipe, remaps, num_remaps);
 	if (ret)
 		goto err_free_new_remaps;
@@ -1436,6 +1791,9 @@ static int max_des_update_pipe_enable(struct max_des_priv *priv,
 		break;
 	}
 
+	if (!enable)
+		clear_bit(pipe->index, &priv->held_pipes);
+
 	if (enable == pipe->enabled)
 		return 0;
 
@@ -1463,6 +1821,11 @@ static int max_des_update_pipe_enable(struct max_des_priv *priv,
 		}
 	}
 
+	if (enable && priv->grouped_start) {
+		set_bit(pipe->index, &priv->held_pipes);
+		return 0;
+	}
+
 	ret = des->ops->set_pipe_enable(des, pipe, enable);
 	if (ret)
 		return ret;
@@ -1507,82 +1870,375 @@ err_revert_update_pipe_remaps:
 	return ret;
 }
 
-static int max_des_init_link_ser_xlate(struct max_des_priv *priv,
-				       struct max_des_link *link,
-				       struct i2c_adapter *adapter,
-				       u8 power_up_addr, u8 new_addr)
+static u64 max_des_phy_bps(struct max_des_phy *phy, u64 link_frequency)
 {
-	struct max_des *des = priv->des;
-	u8 addrs[] = { power_up_addr, new_addr };
-	u8 current_addr;
-	int ret;
+	u64 bps = link_frequency * 2 * phy->mipi.num_data_lanes;
 
-	ret = des->ops->select_links(des, BIT(link->index));
-	if (ret)
-		return ret;
+	/* Each C-PHY trio carries 16 bits every 7 symbols. */
+	if (phy->bus_type == V4L2_MBUS_CSI2_CPHY)
+		bps = div_u64(bps * 16, 7);
 
-	ret = max_ser_wait_for_multiple(adapter, addrs, ARRAY_SIZE(addrs),
-					&current_addr);
-	if (ret) {
-		dev_err(priv->dev,
-			"Failed to wait for serializer at 0x%02x or 0x%02x: %d\n",
-			power_up_addr, new_addr, ret);
-		return ret;
-	}
+	return bps;
+}
 
-	ret = max_ser_reset(adapter, current_addr);
-	if (ret) {
-		dev_err(priv->dev, "Failed to reset serializer: %d\n", ret);
-		return ret;
-	}
+static int max_des_get_bw(struct max_des_priv *priv,
+			  struct v4l2_subdev_state *state,
+			  u64 *streams_masks, struct max_des_bw *bw)
+{
+	struct v4l2_subdev_route *route;
+	int ret;
 
-	ret = max_ser_wait(adapter, power_up_addr);
-	if (ret) {
-		dev_err(priv->dev,
-			"Failed to wait for serializer at 0x%02x: %d\n",
-			power_up_addr, ret);
-		return ret;
-	}
+	memset(bw, 0, sizeof(*bw));
 
-	ret = max_ser_change_address(adapter, power_up_addr, new_addr);
-	if (ret) {
-		dev_err(priv->dev,
-			"Failed to change serializer from 0x%02x to 0x%02x: %d\n",
-			power_up_addr, new_addr, ret);
-		return ret;
-	}
+	for_each_active_route(&state->routing, route) {
+		struct max_des_route_hw hw;
+		u64 bps;
 
-	ret = max_ser_wait(adapter, new_addr);
-	if (ret) {
-		dev_err(priv->dev,
-			"Failed to wait for serializer at 0x%02x: %d\n",
-			new_addr, ret);
-		return ret;
-	}
+		if (streams_masks &&
+		    !(BIT_ULL(route->sink_stream) & streams_masks[route->sink_pad]))
+			continue;
 
-	if (des->ops->fix_tx_ids) {
-		ret = max_ser_fix_tx_ids(adapter, new_addr);
+		ret = max_des_route_to_hw(priv, state, route, &hw);
 		if (ret)
 			return ret;
+
+		ret = max_des_get_route_bps(priv, state, route, &hw, &bps);
+		if (ret)
+			return ret;
+
+		if (!bps)
+			__set_bit(hw.phy->index, &bw->unaccounted_phys);
+
+		bw->phys[hw.phy->index] += bps;
+
+		/* Replicas only add to the load of their PHY. */
+		if (max_des_route_is_replica(&state->routing, route))
+			continue;
+
+		if (!hw.is_tpg)
+			bw->links[route->sink_pad] += bps;
+
+		bw->pipes[hw.pipe->index] += bps;
 	}
 
-	return ret;
+	return 0;
 }
 
-static int max_des_init(struct max_des_priv *priv)
+static int max_des_check_bw(struct max_des_priv *priv, struct max_des_bw *bw)
 {
 	struct max_des *des = priv->des;
 	unsigned int i;
-	int ret;
+	int ret = 0;
 
-	if (des->ops->init) {
-		ret = des->ops->init(des);
-		if (ret)
-			return ret;
-	}
+	for (i = 0; i < des->ops->num_links; i++) {
+		struct max_des_link *link = &des->links[i];
+		u64 bps;
 
-	if (des->ops->set_enable) {
-		ret = des->ops->set_enable(des, false);
+		/* The link rate is only known once a serializer is found. */
+		if (!link->enabled || !link->ser_xlate.en)
+			continue;
+
+		bps = max_serdes_gmsl_version_bps(link->version);
+		if (bw->links[i] <= bps)
+			continue;
+
+		dev_warn(priv->dev, "Link %u oversubscribed: %llu of %llu bps\n",
+			 link->index, bw->links[i], bps);
+		ret = -ENOSPC;
+	}
+
+	for (i = 0; i < des->ops->num_phys; i++) {
+		struct max_des_phy *phy = &des->phys[i];
+		u64 bps;
+
+		if (!phy->enabled)
+			continue;
+
+		bps = max_des_phy_bps(phy, priv->phys_max_link_frequency[i]);
+		if (bw->phys[i] <= bps)
+			continue;
+
+		dev_warn(priv->dev, "PHY %u oversubscribed: %llu of %llu bps\n",
+			 phy->index, bw->phys[i], bps);
+		ret = -ENOSPC;
+	}
+
+	return ret;
+}
+
+static u64 max_des_phy_min_link_freq(struct max_des_priv *priv,
+				     struct max_des_phy *phy,
+				     struct max_des_bw *bw)
+{
+	u64 max_freq = priv->phys_max_link_frequency[phy->index];
+	u64 div = 2 * phy->mipi.num_data_lanes;
+	u64 bps = bw->phys[phy->index];
+	u64 freq;
+
+	/*
+	 * Stay at the firmware link frequency when nothing is routed, or when
+	 * any routed stream is missing from the estimate.
+	 */
+	if (!bps || test_bit(phy->index, &bw->unaccounted_phys))
+		return max_freq;
+
+	bps = div_u64(bps * (100 + MAX_DES_CSI2_OVERHEAD_PERCENT), 100);
+
+	if (phy->bus_type == V4L2_MBUS_CSI2_CPHY)
+		bps = div_u64(bps * 7, 16);
+
+	freq = div64_u64(bps + div - 1, div);
+
+	/* The DPLLs are programmed in 100Mbps steps. */
+	freq = max(freq, MAX_DES_LINK_FREQUENCY_MIN);
+	freq = DIV64_U64_ROUND_UP(freq, MAX_DES_LINK_FREQUENCY_STEP) *
+	       MAX_DES_LINK_FREQUENCY_STEP;
+
+	return min(freq, max_freq);
+}
+
+static void max_des_update_link_freq_ctrl(struct max_des_priv *priv)
+{
+	struct max_des_phy *phy = priv->link_freq_phy;
+	unsigned int i;
+
+	if (!priv->link_freq_ctrl)
+		return;
+
+	for (i = 0; i < priv->num_link_freqs; i++)
+		if (priv->link_freq_menu[i] == phy->link_frequency)
+			break;
+
+	if (i == priv->num_link_freqs)
+		return;
+
+	v4l2_ctrl_s_ctrl(priv->link_freq_ctrl, i);
+}
+
+/*
+ * Pick the lowest link frequency which fits the routed streams for every
+ * PHY, to save power when only a few of the cameras are in use. Only
+ * called while not streaming, the receivers read the link frequency
+ * through get_mbus_config() before enabling the streams. Nothing is
+ * programmed here, formats are set one stream at a time and the PHYs are
+ * only reprogrammed once streams get enabled, see
+ * max_des_apply_link_freqs().
+ */
+static int max_des_update_link_freqs(struct max_des_priv *priv,
+				     struct v4l2_subdev_state *state)
+{
+	struct max_des *des = priv->des;
+	struct max_des_bw bw;
+	unsigned int i;
+
+	if (max_des_get_bw(priv, state, NULL, &bw))
+		return 0;
+
+	for (i = 0; i < des->ops->num_phys; i++) {
+		struct max_des_phy *phy = &des->phys[i];
+		u64 freq;
+
+		if (!phy->enabled)
+			continue;
+
+		freq = max_des_phy_min_link_freq(priv, phy, &bw);
+		if (freq == phy->link_frequency)
+			continue;
+
+		dev_dbg(priv->dev, "PHY %u link frequency %llu -> %llu\n",
+			phy->index, phy->link_frequency, freq);
+
+		phy->link_frequency = freq;
+
+		if (phy == priv->link_freq_phy)
+			max_des_update_link_freq_ctrl(priv);
+	}
+
+	return 0;
+}
+
+/*
+ * Reprogram the PHYs without streams whose link frequency differs from the
+ * one they run at, which resets their DPLL.
+ */
+static int max_des_apply_link_freqs(struct max_des_priv *priv)
+{
+	struct max_des *des = priv->des;
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < des->ops->num_phys; i++) {
+		struct max_des_phy *phy = &des->phys[i];
+
+		if (!phy->enabled ||
+		    phy->link_frequency == priv->phys_link_frequency_applied[i] ||
+		    priv->streams_masks[max_des_phy_to_pad(des, phy)])
+			continue;
+
+		ret = des->ops->init_phy(des, phy);
+		if (ret)
+			return ret;
+
+		priv->phys_link_frequency_applied[i] = phy->link_frequency;
+	}
+
+	return 0;
+}
+
+/*
+ * The link frequency is not changed once streaming may have started, catch
+ * pixel rates which went up since it was picked.
+ */
+static int max_des_check_link_freqs(struct max_des_priv *priv,
+				    struct max_des_bw *bw)
+{
+	struct max_des *des = priv->des;
+	unsigned int i;
+	int ret = 0;
+
+	for (i = 0; i < des->ops->num_phys; i++) {
+		struct max_des_phy *phy = &des->phys[i];
+		u64 freq;
+
+		if (!phy->enabled)
+			continue;
+
+		freq = max_des_phy_min_link_freq(priv, phy, bw);
+		if (freq <= phy->link_frequency)
+			continue;
+
+		dev_warn(priv->dev, "PHY %u needs %llu Hz, link frequency is %llu Hz\n",
+			 phy->index, freq, phy->link_frequency);
+		ret = -ENOSPC;
+	}
+
+	return ret;
+}
+
+static int max_des_wait_link_lock(struct max_des_priv *priv,
+				  struct max_des_link *link)
+{
+	struct max_des *des = priv->des;
+	bool locked = false;
+	int ret, err;
+
+	if (!des->ops->get_link_lock)
+		return 0;
+
+	err = read_poll_timeout(des->ops->get_link_lock, ret, ret || locked,
+				MAX_DES_LINK_LOCK_POLL_US,
+				MAX_DES_LINK_LOCK_TIMEOUT_US, false,
+				des, link, &locked);
+	if (ret == -EOPNOTSUPP)
+		return 0;
+
+	return ret ?: err;
+}
+
+static int max_des_init_link_ser_xlate(struct max_des_priv *priv,
+				       struct max_des_link *link,
+				       struct i2c_adapter *adapter,
+				       u8 power_up_addr, u8 new_addr)
+{
+	struct max_des *des = priv->des;
+	u8 addrs[] = {
+		power_up_addr,
+		new_addr,
+		/* A serializer left at a previous alias. */
+		link->ser_xlate.en ? link->ser_xlate.src : new_addr,
+	};
+	u8 current_addr;
+	int ret;
+
+	ret = des->ops->select_links(des, BIT(link->index));
+	if (ret)
+		return ret;
+
+	/*
+	 * A locked link has a serializer to talk to right away. A serializer
+	 * powered over the coax may still be booting after the lock timeout
+	 * though, so fall back to the I2C retries instead of giving up on
+	 * the current version.
+	 */
+	ret = max_des_wait_link_lock(priv, link);
+	if (ret == -ETIMEDOUT)
+		dev_dbg(priv->dev, "Link %u not locked yet, probing I2C\n",
+			link->index);
+	else if (ret)
+		return ret;
+
+	ret = max_ser_wait_for_multiple(adapter, addrs, ARRAY_SIZE(addrs),
+					&current_addr);
+	if (ret) {
+		dev_err(priv->dev,
+			"Failed to wait for serializer at 0x%02x or 0x%02x: %d\n",
+			power_up_addr, new_addr, ret);
+		return ret;
+	}
+
+	/*
+	 * A serializer still answering at its power-up address after the
+	 * parallel reset doesn't need to be reset again.
+	 */
+	if (!(test_and_clear_bit(link->index, &priv->ser_reset_links) &&
+	      current_addr == power_up_addr)) {
+		ret = max_ser_reset(adapter, current_addr);
+		if (ret) {
+			dev_err(priv->dev, "Failed to reset serializer: %d\n", ret);
+			return ret;
+		}
+
+		ret = max_ser_wait(adapter, power_up_addr);
+		if (ret) {
+			dev_err(priv->dev,
+				"Failed to wait for serializer at 0x%02x: %d\n",
+				power_up_addr, ret);
+			return ret;
+		}
+	}
+
+	ret = max_ser_change_address(adapter, power_up_addr, new_addr);
+	if (ret) {
+		dev_err(priv->dev,
+			"Failed to change serializer from 0x%02x to 0x%02x: %d\n",
+			power_up_addr, new_addr, ret);
+		return ret;
+	}
+
+	ret = max_ser_wait(adapter, new_addr);
+	if (ret) {
+		dev_err(priv->dev,
+			"Failed to wait for serializer at 0x%02x: %d\n",
+			new_addr, ret);
+		return ret;
+	}
+
+	if (des->ops->fix_tx_ids) {
+		ret = max_ser_fix_tx_ids(adapter, new_addr);
+		if (ret)
+			return ret;
+	}
+
+	return ret;
+}
+
+static int max_des_init(struct max_des_priv *priv)
+{
+	struct max_des *des = priv->des;
+	unsigned int i;
+	int ret;
+
+	priv->pipes_phy_applied = false;
+	priv->tunnel_applied = false;
+
+	if (des->ops->init) {
+		ret = des->ops->init(des);
+		if (ret)
+			return ret;
+	}
+
+	if (des->ops->set_enable) {
+		ret = des->ops->set_enable(des, false);
 		if (ret)
 			return ret;
 	}
@@ -1594,6 +2250,8 @@ static int max_des_init(struct max_des_priv *priv)
 			ret = des->ops->init_phy(des, phy);
 			if (ret)
 				return ret;
+
+			priv->phys_link_frequency_applied[i] = phy->link_frequency;
 		}
 
 		ret = des->ops->set_phy_enable(des, phy, phy->enabled);
@@ -1683,14 +2341,21 @@ static int max_des_ser_attach_addr(struct max_des_priv *priv, u32 chan_id,
 	int i, min, max;
 	int ret = 0;
 
-	max_des_ser_find_version_range(des, &min, &max);
-
-	if (link->ser_xlate.en) {
+	if (test_bit(link->index, &priv->ser_bound_links)) {
 		dev_err(priv->dev, "Serializer for link %u already bound\n",
 			link->index);
 		return -EINVAL;
 	}
 
+	/* The serializer is still at the same alias since its last attach. */
+	if (link->ser_xlate.en && link->ser_xlate.src == alias &&
+	    link->ser_xlate.dst == addr) {
+		set_bit(link->index, &priv->ser_bound_links);
+		return 0;
+	}
+
+	max_des_ser_find_version_range(des, &min, &max);
+
 	for (i = max; i >= min; i--) {
 		if (!(des->ops->versions & BIT(i)))
 			continue;
@@ -1717,22 +2382,78 @@ static int max_des_ser_attach_addr(struct max_des_priv *priv, u32 chan_id,
 	link->ser_xlate.src = alias;
 	link->ser_xlate.dst = addr;
 	link->ser_xlate.en = true;
+	set_bit(link->index, &priv->ser_bound_links);
 
 	return 0;
 }
 
+static void max_des_ser_detach_addr(struct max_des_priv *priv, u32 chan_id)
+{
+	clear_bit(chan_id, &priv->ser_bound_links);
+}
+
 #if IS_REACHABLE(CONFIG_I2C_ATR)
+static int max_des_select_enabled_links(struct max_des_priv *priv)
+{
+	struct max_des *des = priv->des;
+	unsigned int mask = 0;
+	unsigned int i;
+
+	for (i = 0; i < des->ops->num_links; i++) {
+		struct max_des_link *link = &des->links[i];
+
+		if (!link->enabled)
+			continue;
+
+		mask |= BIT(link->index);
+	}
+
+	return des->ops->select_links(des, mask);
+}
+
 static int max_des_ser_atr_attach_addr(struct i2c_atr *atr, u32 chan_id,
 				       u16 addr, u16 alias)
 {
 	struct max_des_priv *priv = i2c_atr_get_driver_data(atr);
+	int ret;
+
+	ret = max_des_ser_attach_addr(priv, chan_id, addr, alias);
+	if (ret)
+		return ret;
 
-	return max_des_ser_attach_addr(priv, chan_id, addr, alias);
+	return max_des_select_enabled_links(priv);
 }
 
 static void max_des_ser_atr_detach_addr(struct i2c_atr *atr, u32 chan_id, u16 addr)
 {
-	/* Don't do anything. */
+	struct max_des_priv *priv = i2c_atr_get_driver_data(atr);
+	struct max_des *des = priv->des;
+	struct max_des_link *link = &des->links[chan_id];
+	int ret;
+
+	max_des_ser_detach_addr(priv, chan_id);
+
+	if (!link->ser_xlate.en)
+		return;
+
+	/*
+	 * The ATR returns the alias to its pool, move the serializer back to
+	 * its power-up address so that it doesn't answer a later user of the
+	 * alias.
+	 */
+	link->ser_xlate.en = false;
+
+	ret = des->ops->select_links(des, BIT(link->index));
+	if (!ret)
+		ret = max_ser_change_address(priv->client->adapter,
+					     link->ser_xlate.src,
+					     link->ser_xlate.dst);
+	if (ret)
+		dev_warn(priv->dev,
+			 "Failed to move serializer for link %u back to 0x%02x: %d\n",
+			 link->index, link->ser_xlate.dst, ret);
+
+	max_des_select_enabled_links(priv);
 }
 
 static const struct i2c_atr_ops max_des_i2c_atr_ops = {
@@ -1755,66 +2476,181 @@ static void max_des_i2c_atr_deinit(struct max_des_priv *priv)
 	i2c_atr_delete(priv->atr);
 }
 
-static int max_des_i2c_atr_init(struct max_des_priv *priv)
+static struct fwnode_handle *max_des_i2c_atr_chan_fwnode(struct max_des_priv *priv,
+							   unsigned int index)
 {
-	struct max_des *des = priv->des;
-	unsigned int mask = 0;
-	unsigned int i;
-	int ret;
+	struct fwnode_handle *child;
 
-	if (!i2c_check_functionality(priv->client->adapter,
-				     I2C_FUNC_SMBUS_WRITE_BYTE_DATA))
-		return -ENODEV;
+	/* Find the channel fwnode child matching this link index */
+	fwnode_for_each_child_node(dev_fwnode(priv->dev), child) {
+		u32 reg;
 
-	priv->atr = i2c_atr_new(priv->client->adapter, priv->dev,
-				&max_des_i2c_atr_ops, des->ops->num_links,
-				I2C_ATR_F_STATIC | I2C_ATR_F_PASSTHROUGH);
-	if (IS_ERR(priv->atr))
-		return PTR_ERR(priv->atr);
+		if (fwnode_property_read_u32(child, "reg", &reg))
+			continue;
+		if (reg == index)
+			return child;
+	}
 
-	i2c_atr_set_driver_data(priv->atr, priv);
+	return NULL;
+}
 
-	for (i = 0; i < des->ops->num_links; i++) {
-		struct max_des_link *link = &des->links[i];
-		struct fwnode_handle *child = NULL, *chan_fwnode = NULL;
-		struct i2c_atr_adap_desc desc = {
-			.chan_id = i,
-		};
+static int max_des_i2c_atr_ser_addr(struct max_des_priv *priv,
+				    unsigned int index, u8 *addr)
+{
+	struct fwnode_handle *chan_fwnode, *child;
+	int ret = -ENOENT;
+	u32 reg;
+
+	chan_fwnode = max_des_i2c_atr_chan_fwnode(priv, index);
+	if (!chan_fwnode)
+		return -ENOENT;
+
+	fwnode_for_each_child_node(chan_fwnode, child) {
+		if (fwnode_property_read_u32(child, "reg", &reg))
+			continue;
+
+		*addr = reg;
+		ret = 0;
+		fwnode_handle_put(child);
+		break;
+	}
+
+	fwnode_handle_put(chan_fwnode);
+
+	return ret;
+}
+
+/*
+ * Reset all the serializers at once by selecting all the links and issuing
+ * a single reset at their shared power-up address, then let the links relock
+ * in parallel. Attaching each serializer afterwards only has to move it to
+ * its alias, instead of also going through a reset and settle cycle.
+ *
+ * This is purely an optimization, any link that doesn't make it through
+ * falls back to the full sequence when its serializer is attached.
+ */
+static void max_des_i2c_atr_reset_sers(struct max_des_priv *priv)
+{
+	struct i2c_adapter *adapter = priv->client->adapter;
+	struct max_des *des = priv->des;
+	unsigned long mask = 0;
+	u8 addrs[MAX_DES_NUM_LINKS];
+	int version;
+	unsigned int i, j;
+	int ret;
+
+	if (!des->ops->select_links)
+		return;
+
+	version = fls(des->ops->versions) - 1;
+	if (version < 0)
+		return;
+
+	for (i = 0; i < des->ops->num_links; i++) {
+		struct max_des_link *link = &des->links[i];
 
 		if (!link->enabled)
 			continue;
 
-		/* Find the channel fwnode child matching this link index */
-		fwnode_for_each_child_node(dev_fwnode(priv->dev), child) {
-			u32 reg;
+		if (max_des_i2c_atr_ser_addr(priv, link->index, &addrs[i]))
+			continue;
+
+		if (des->ops->set_link_version) {
+			ret = des->ops->set_link_version(des, link, version);
+			if (ret)
+				return;
+		}
+
+		mask |= BIT(link->index);
+	}
 
-			if (fwnode_property_read_u32(child, "reg", &reg))
-				continue;
-			if (reg == i) {
-				chan_fwnode = child;
+	if (hweight_long(mask) < 2)
+		return;
+
+	ret = des->ops->select_links(des, mask);
+	if (ret)
+		return;
+
+	for_each_set_bit(i, &mask, des->ops->num_links) {
+		for (j = 0; j < i; j++)
+			if (test_bit(j, &mask) && addrs[j] == addrs[i])
 				break;
-			}
-		}
 
-		desc.bus_handle = chan_fwnode;
+		if (j < i)
+			continue;
+
+		/*
+		 * Serializers which have already been moved to their alias
+		 * don't answer, the attach path takes care of them.
+		 */
+		ret = max_ser_broadcast_reset(adapter, addrs[i]);
+		if (!ret)
+			continue;
 
-		ret = i2c_atr_add_adapter(priv->atr, &desc);
-		if (ret) {
-			fwnode_handle_put(chan_fwnode);
-			goto err_add_adapters;
-		}
+		dev_dbg(priv->dev,
+			"Failed to reset serializers at 0x%02x: %d\n",
+			addrs[i], ret);
+
+		/* Leave the reset of these links to the attach path. */
+		for (j = i; j < des->ops->num_links; j++)
+			if (test_bit(j, &mask) && addrs[j] == addrs[i])
+				__clear_bit(j, &mask);
+	}
+
+	/* Give the links time to drop before waiting for them to relock. */
+	fsleep(MAX_DES_SER_RESET_US);
+
+	/* Settle times of all the links overlap here. */
+	for_each_set_bit(i, &mask, des->ops->num_links) {
+		ret = max_des_wait_link_lock(priv, &des->links[i]);
+		if (ret)
+			__clear_bit(i, &mask);
 	}
 
+	priv->ser_reset_links = mask;
+}
+
+static int max_des_i2c_atr_init(struct max_des_priv *priv)
+{
+	struct max_des *des = priv->des;
+	unsigned int i;
+	int ret;
+
+	if (!i2c_check_functionality(priv->client->adapter,
+				     I2C_FUNC_SMBUS_WRITE_BYTE_DATA))
+		return -ENODEV;
+
+	priv->atr = i2c_atr_new(priv->client->adapter, priv->dev,
+				&max_des_i2c_atr_ops, des->ops->num_links,
+				I2C_ATR_F_STATIC | I2C_ATR_F_PASSTHROUGH);
+	if (IS_ERR(priv->atr))
+		return PTR_ERR(priv->atr);
+
+	i2c_atr_set_driver_data(priv->atr, priv);
+
+	max_des_i2c_atr_reset_sers(priv);
+
 	for (i = 0; i < des->ops->num_links; i++) {
 		struct max_des_link *link = &des->links[i];
+		struct i2c_atr_adap_desc desc = {
+			.chan_id = i,
+		};
 
 		if (!link->enabled)
 			continue;
 
-		mask |= BIT(link->index);
+		desc.bus_handle = max_des_i2c_atr_chan_fwnode(priv, i);
+
+		ret = i2c_atr_add_adapter(priv->atr, &desc);
+		if (ret) {
+			fwnode_handle_put(desc.bus_handle);
+			goto err_add_adapters;
+		}
+
+		max_serdes_register_swnode_clients(priv->dev, desc.bus_handle);
 	}
 
-	return des->ops->select_links(des, mask);
+	return max_des_select_enabled_links(priv);
 
 err_add_adapters:
 	max_des_i2c_atr_deinit(priv);
@@ -1842,7 +2678,8 @@ static int max_des_i2c_mux_bus_notifier_call(struct notifier_block *nb,
 	 * BUS_NOTIFY_ADD_DEVICE, but the adapters list is only populated with
 	 * the new adapter after BUS_NOTIFY_ADD_DEVICE is issued.
 	 */
-	if (event != BUS_NOTIFY_BIND_DRIVER)
+	if (event != BUS_NOTIFY_BIND_DRIVER &&
+	    event != BUS_NOTIFY_UNBOUND_DRIVER)
 		return NOTIFY_DONE;
 
 	client = i2c_verify_client(dev);
@@ -1857,6 +2694,11 @@ static int max_des_i2c_mux_bus_notifier_call(struct notifier_block *nb,
 	if (chan_id == priv->mux->max_adapters)
 		return NOTIFY_DONE;
 
+	if (event == BUS_NOTIFY_UNBOUND_DRIVER) {
+		max_des_ser_detach_addr(priv, chan_id);
+		return NOTIFY_DONE;
+	}
+
 	max_des_ser_attach_addr(priv, chan_id, client->addr, client->addr);
 
 	return NOTIFY_DONE;
@@ -1968,6 +2810,29 @@ static int max_des_set_tpg_fmt(struct v4l2_subdev *sd,
 	return 0;
 }
 
+static void max_des_propagate_tpg_fmt(struct v4l2_subdev_state *state, u32 pad,
+				      const struct v4l2_mbus_framefmt *format)
+{
+	struct v4l2_subdev_route *route;
+
+	for_each_active_route(&state->routing, route) {
+		struct v4l2_mbus_framefmt *fmt;
+
+		if (route->sink_pad != pad)
+			continue;
+
+		fmt = v4l2_subdev_state_get_format(state, route->sink_pad,
+						   route->sink_stream);
+		if (fmt)
+			*fmt = *format;
+
+		fmt = v4l2_subdev_state_get_format(state, route->source_pad,
+						   route->source_stream);
+		if (fmt)
+			*fmt = *format;
+	}
+}
+
 static int max_des_set_fmt(struct v4l2_subdev *sd,
 			   struct v4l2_subdev_state *state,
 			   struct v4l2_subdev_format *format)
@@ -1985,9 +2850,17 @@ static int max_des_set_fmt(struct v4l2_subdev *sd,
 		return v4l2_subdev_get_fmt(sd, state, format);
 
 	if (max_des_pad_is_tpg(des, format->pad)) {
+		/* All TPG streams share the format of the first one. */
+		if (format->stream != MAX_SERDES_TPG_STREAM)
+			return v4l2_subdev_get_fmt(sd, state, format);
+
 		ret = max_des_set_tpg_fmt(sd, state, format);
 		if (ret)
 			return ret;
+
+		max_des_propagate_tpg_fmt(state, format->pad, &format->format);
+
+		goto out;
 	}
 
 	fmt = v4l2_subdev_state_get_format(state, format->pad, format->stream);
@@ -2003,7 +2876,12 @@ static int max_des_set_fmt(struct v4l2_subdev *sd,
 
 	*fmt = format->format;
 
-	return 0;
+out:
+	/* The format is part of the bandwidth estimate. */
+	if (format->which != V4L2_SUBDEV_FORMAT_ACTIVE)
+		return 0;
+
+	return max_des_update_link_freqs(priv, state);
 }
 
 static int max_des_enum_frame_interval(struct v4l2_subdev *sd,
@@ -2191,6 +3069,86 @@ static int max_des_log_status(struct v4l2_subdev *sd)
 	return 0;
 }
 
+static int max_des_get_fsync_period(struct max_des_priv *priv,
+				    unsigned int *period_us)
+{
+	struct max_des *des = priv->des;
+	unsigned int i;
+
+	if (priv->fsync_period_ctrl->val) {
+		*period_us = priv->fsync_period_ctrl->val;
+		return 0;
+	}
+
+	/* Derive the period from the frame interval of the first sensor. */
+	for (i = 0; i < des->ops->num_links; i++) {
+		struct max_des_link *link = &des->links[i];
+		struct max_serdes_source *source = max_des_get_link_source(priv, link);
+		struct v4l2_fract interval;
+
+		if (!link->enabled || !source->sd)
+			continue;
+
+		if (max_serdes_get_frame_interval(source->sd, &interval))
+			continue;
+
+		*period_us = div_u64((u64)interval.numerator * USEC_PER_SEC,
+				     interval.denominator);
+		return 0;
+	}
+
+	return -ENOENT;
+}
+
+static int max_des_update_fsync(struct max_des_priv *priv)
+{
+	struct max_des_fsync fsync = { 0 };
+	struct max_des *des = priv->des;
+	unsigned int i;
+	int ret;
+
+	if (!priv->fsync_mode_ctrl)
+		return 0;
+
+	switch (priv->fsync_mode_ctrl->val) {
+	case MAX_DES_FSYNC_MODE_CONTINUOUS:
+		fsync.enable = true;
+		break;
+	case MAX_DES_FSYNC_MODE_SYNC_START:
+		fsync.enable = priv->fsync_armed;
+		break;
+	}
+
+	if (fsync.enable) {
+		ret = max_des_get_fsync_period(priv, &fsync.period_us);
+		if (ret) {
+			dev_err(priv->dev, "Cannot find frame sync period\n");
+			return ret;
+		}
+
+		for (i = 0; i < des->ops->num_links; i++)
+			if (des->links[i].enabled)
+				fsync.links |= BIT(i);
+
+		fsync.tx_id = priv->fsync_tx_id;
+	}
+
+	if (fsync.enable == priv->fsync.enable &&
+	    (!fsync.enable ||
+	     (fsync.period_us == priv->fsync.period_us &&
+	      fsync.links == priv->fsync.links &&
+	      fsync.tx_id == priv->fsync.tx_id)))
+		return 0;
+
+	ret = des->ops->set_fsync(des, &fsync);
+	if (ret)
+		return ret;
+
+	priv->fsync = fsync;
+
+	return 0;
+}
+
 static int max_des_s_ctrl(struct v4l2_ctrl *ctrl)
 {
 	struct max_des_priv *priv = ctrl_to_priv(ctrl->handler);
@@ -2200,6 +3158,15 @@ static int max_des_s_ctrl(struct v4l2_ctrl *ctrl)
 	case V4L2_CID_TEST_PATTERN:
 		des->tpg_pattern = ctrl->val;
 		return 0;
+	case V4L2_CID_LINK_FREQ:
+		/* Only ever updated by the driver itself. */
+		return 0;
+	case MAX_SERDES_CID_FSYNC_MODE:
+	case MAX_SERDES_CID_FSYNC_PERIOD:
+		return max_des_update_fsync(priv);
+	case MAX_SERDES_CID_GROUPED_START:
+		/* Sampled when streams are enabled or disabled. */
+		return 0;
 	}
 
 	return -EINVAL;
@@ -2279,6 +3246,7 @@ static int max_des_get_mbus_config(struct v4l2_subdev *sd, unsigned int pad,
 
 	cfg->type = phy->bus_type;
 	cfg->bus.mipi_csi2 = phy->mipi;
+	/* Per PHY, the LINK_FREQ control only follows the first one. */
 	cfg->link_freq = phy->link_frequency;
 
 	return 0;
@@ -2294,7 +3262,7 @@ static int max_des_set_tpg_routing(struct v4l2_subdev *sd,
 	struct v4l2_mbus_framefmt fmt = { 0 };
 	int ret;
 
-	ret = max_serdes_validate_tpg_routing(routing);
+	ret = max_serdes_validate_tpg_routing(routing, des->ops->num_pipes);
 	if (ret)
 		return ret;
 
@@ -2307,6 +3275,49 @@ static int max_des_set_tpg_routing(struct v4l2_subdev *sd,
 	return v4l2_subdev_set_routing_with_fmt(sd, state, routing, &fmt);
 }
 
+static u64 max_des_sink_stream_source_pads(const struct v4l2_subdev_krouting *routing,
+					   u32 sink_pad, u32 sink_stream)
+{
+	struct v4l2_subdev_route *route;
+	u64 pads = 0;
+
+	for_each_active_route(routing, route)
+		if (route->sink_pad == sink_pad && route->sink_stream == sink_stream)
+			pads |= BIT_ULL(route->source_pad);
+
+	return pads;
+}
+
+/*
+ * A sink stream can be replicated to multiple source pads, but only once
+ * per source pad, and all streams of a sink pad must be sent to the same
+ * source pads.
+ */
+static int max_des_validate_replicas(const struct v4l2_subdev_krouting *routing)
+{
+	struct v4l2_subdev_route *route, *other;
+
+	for_each_active_route(routing, route) {
+		u64 pads = max_des_sink_stream_source_pads(routing, route->sink_pad,
+							   route->sink_stream);
+
+		for_each_active_route(routing, other) {
+			if (other == route || other->sink_pad != route->sink_pad)
+				continue;
+
+			if (other->sink_stream == route->sink_stream &&
+			    other->source_pad == route->source_pad)
+				return -EINVAL;
+
+			if (max_des_sink_stream_source_pads(routing, other->sink_pad,
+							    other->sink_stream) != pads)
+				return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
 static int __max_des_set_routing(struct v4l2_subdev *sd,
 				 struct v4l2_subdev_state *state,
 				 struct v4l2_subdev_krouting *routing)
@@ -2325,8 +3336,11 @@ static int __max_des_set_routing(struct v4l2_subdev *sd,
 	}
 
 	ret = v4l2_subdev_routing_validate(sd, routing,
-					   V4L2_SUBDEV_ROUTING_ONLY_1_TO_1 |
-					   V4L2_SUBDEV_ROUTING_NO_SINK_STREAM_MIX);
+					   V4L2_SUBDEV_ROUTING_NO_N_TO_1);
+	if (ret)
+		return ret;
+
+	ret = max_des_validate_replicas(routing);
 	if (ret)
 		return ret;
 
@@ -2357,11 +3371,28 @@ static int max_des_set_routing(struct v4l2_subdev *sd,
 {
 	struct max_des_priv *priv = sd_to_priv(sd);
 	struct max_des *des = priv->des;
+	struct max_des_bw bw;
+	int ret;
 
 	if (which == V4L2_SUBDEV_FORMAT_ACTIVE && des->active)
 		return -EBUSY;
 
-	return __max_des_set_routing(sd, state, routing);
+	ret = __max_des_set_routing(sd, state, routing);
+	if (ret)
+		return ret;
+
+	/*
+	 * Only warn here, formats are not final yet and not all the routes
+	 * have to be streamed at the same time. Enabling the streams will
+	 * fail if they don't fit.
+	 */
+	if (which != V4L2_SUBDEV_FORMAT_ACTIVE)
+		return 0;
+
+	if (!max_des_get_bw(priv, state, NULL, &bw))
+		max_des_check_bw(priv, &bw);
+
+	return max_des_update_link_freqs(priv, state);
 }
 
 static int max_des_update_link(struct max_des_priv *priv,
@@ -2493,134 +3524,687 @@ err:
 	return ret;
 }
 
-static int max_des_enable_disable_streams(struct max_des_priv *priv,
-					  struct v4l2_subdev_state *state,
-					  u32 pad, u64 updated_streams_mask,
-					  bool enable)
+static int max_des_source_enable_disable_streams(struct max_des_priv *priv,
+						 u32 pad, u64 streams_mask,
+						 bool enable)
 {
-	struct max_des *des = priv->des;
+	struct max_serdes_source *source = &priv->sources[pad];
+
+	if (!source->sd)
+		return 0;
 
-	return max_serdes_xlate_enable_disable_streams(priv->sources, 0, state,
-						       pad, updated_streams_mask, 0,
-						       des->ops->num_links, enable);
+	if (enable)
+		return v4l2_subdev_enable_streams(source->sd, source->pad,
+						  streams_mask);
+
+	return v4l2_subdev_disable_streams(source->sd, source->pad,
+					   streams_mask);
 }
 
-static int max_des_update_streams(struct v4l2_subdev *sd,
-				  struct v4l2_subdev_state *state,
-				  u32 pad, u64 updated_streams_mask, bool enable)
+/*
+ * Start or stop the remote streams whose sink stream state changed. A sink
+ * stream replicated to multiple PHYs is only started by its first user and
+ * stopped by its last one.
+ */
+static int max_des_enable_disable_streams(struct max_des_priv *priv,
+					  u64 *old_streams_masks,
+					  u64 *new_streams_masks, bool enable)
 {
-	struct max_des_priv *priv = v4l2_get_subdevdata(sd);
-	struct max_des_remap_context context = { 0 };
-	struct max_des_mode_context mode_context = { 0 };
 	struct max_des *des = priv->des;
-	unsigned int num_pads = max_des_num_pads(des);
-	u64 *streams_masks;
+	unsigned int i;
+	u64 mask;
 	int ret;
 
-	ret = max_des_populate_remap_context(priv, &context, state);
-	if (ret)
-		return ret;
+	for (i = 0; i < des->ops->num_links; i++) {
+		mask = enable ? new_streams_masks[i] & ~old_streams_masks[i]
+			      : old_streams_masks[i] & ~new_streams_masks[i];
+		if (!mask)
+			continue;
 
-	ret = max_des_populate_mode_context(priv, &mode_context, state, context.mode);
-	if (ret)
-		return ret;
+		ret = max_des_source_enable_disable_streams(priv, i, mask, enable);
+		if (ret)
+			goto err;
+	}
 
-	ret = max_serdes_get_streams_masks(priv->dev, state, pad, updated_streams_mask,
-					   num_pads, priv->streams_masks, &streams_masks,
-					   enable);
-	if (ret)
-		return ret;
+	return 0;
 
-	ret = max_des_set_pipes_phy(priv, &context);
-	if (ret)
-		goto err_free_streams_masks;
+err:
+	while (i--) {
+		mask = enable ? new_streams_masks[i] & ~old_streams_masks[i]
+			      : old_streams_masks[i] & ~new_streams_masks[i];
+		if (!mask)
+			continue;
 
-	ret = max_des_set_tunnel(priv, &context);
-	if (ret)
-		goto err_free_streams_masks;
+		max_des_source_enable_disable_streams(priv, i, mask, !enable);
+	}
 
-	ret = max_des_set_modes(priv, &mode_context);
-	if (ret)
-		goto err_free_streams_masks;
+	return ret;
+}
+
+static bool max_des_all_streams_enabled(struct v4l2_subdev_state *state,
+					u64 *streams_masks)
+{
+	struct v4l2_subdev_route *route;
+	bool routed = false;
+
+	for_each_active_route(&state->routing, route) {
+		if (!(BIT_ULL(route->sink_stream) & streams_masks[route->sink_pad]))
+			return false;
+
+		routed = true;
+	}
+
+	return routed;
+}
+
+/*
+ * Timestamp the video lock of the released pipes, reading each pending pipe
+ * once per run.
+ */
+static void max_des_start_skew_work(struct work_struct *work)
+{
+	struct max_des_priv *priv = container_of(to_delayed_work(work),
+						 struct max_des_priv,
+						 start_skew_work);
+	struct max_des *des = priv->des;
+	s64 min_us = S64_MAX;
+	s64 max_us = 0;
+	unsigned int i;
+	bool locked;
+	s64 now_us;
+	int ret;
+
+	for_each_set_bit(i, &priv->start_pending_pipes, des->ops->num_pipes) {
+		ret = des->ops->get_pipe_video_lock(des, &des->pipes[i], &locked);
+		if (ret || !locked)
+			continue;
+
+		now_us = ktime_us_delta(ktime_get(), priv->start_release);
+
+		mutex_lock(&priv->start_skew_lock);
+		priv->start_lock_us[i] = now_us;
+		__set_bit(i, &priv->start_locked_pipes);
+		mutex_unlock(&priv->start_skew_lock);
+
+		__clear_bit(i, &priv->start_pending_pipes);
+	}
+
+	if (priv->start_pending_pipes &&
+	    ktime_us_delta(ktime_get(), priv->start_release) <=
+	    MAX_DES_START_SKEW_TIMEOUT_US) {
+		schedule_delayed_work(&priv->start_skew_work,
+				      usecs_to_jiffies(MAX_DES_START_SKEW_POLL_US));
+		return;
+	}
+
+	mutex_lock(&priv->start_skew_lock);
+
+	for_each_set_bit(i, &priv->start_locked_pipes, des->ops->num_pipes) {
+		min_us = min(min_us, priv->start_lock_us[i]);
+		max_us = max(max_us, priv->start_lock_us[i]);
+	}
+
+	if (priv->start_locked_pipes)
+		priv->start_skew_us = max_us - min_us;
+
+	mutex_unlock(&priv->start_skew_lock);
+
+	if (priv->start_pending_pipes)
+		dev_warn(priv->dev, "Pipes %#lx did not lock after grouped start\n",
+			 priv->start_pending_pipes);
+
+	dev_dbg(priv->dev, "Grouped start of pipes %#lx, skew %lld us\n",
+		priv->start_locked_pipes | priv->start_pending_pipes,
+		priv->start_skew_us);
+}
+
+static void max_des_measure_start_skew(struct max_des_priv *priv,
+				       unsigned long mask, ktime_t release)
+{
+	struct max_des *des = priv->des;
+
+	cancel_delayed_work_sync(&priv->start_skew_work);
+
+	mutex_lock(&priv->start_skew_lock);
+	priv->start_locked_pipes = 0;
+	priv->start_skew_us = 0;
+	mutex_unlock(&priv->start_skew_lock);
+
+	if (!des->ops->get_pipe_video_lock)
+		return;
+
+	priv->start_release = release;
+	priv->start_pending_pipes = mask;
+
+	schedule_delayed_work(&priv->start_skew_work, 0);
+}
+
+static int max_des_release_pipes(struct max_des_priv *priv, unsigned long mask)
+{
+	struct max_des *des = priv->des;
+	ktime_t release;
+	unsigned int i;
+	int ret = 0;
+
+	mask &= priv->held_pipes;
+	if (!mask)
+		return 0;
+
+	if (des->ops->set_pipes_enable) {
+		ret = des->ops->set_pipes_enable(des, mask, true);
+	} else {
+		for_each_set_bit(i, &mask, des->ops->num_pipes) {
+			ret = des->ops->set_pipe_enable(des, &des->pipes[i], true);
+			if (ret)
+				break;
+		}
+	}
+
+	release = ktime_get();
+
+	if (ret) {
+		for_each_set_bit(i, &mask, des->ops->num_pipes)
+			des->ops->set_pipe_enable(des, &des->pipes[i], false);
+
+		return ret;
+	}
+
+	for_each_set_bit(i, &mask, des->ops->num_pipes)
+		des->pipes[i].enabled = true;
+
+	priv->held_pipes &= ~mask;
+
+	max_des_measure_start_skew(priv, mask, release);
+
+	return 0;
+}
+
+static void max_des_update_link_monitor(struct max_des_priv *priv)
+{
+	struct max_des *des = priv->des;
+
+	if (!des->ops->get_link_lock && !des->ops->get_pipe_video_lock)
+		return;
+
+	if (des->active) {
+		schedule_delayed_work(&priv->link_monitor,
+				      msecs_to_jiffies(MAX_DES_LINK_MONITOR_MS));
+		return;
+	}
+
+	/*
+	 * The worker takes the state lock, which is held here, so it cannot
+	 * be waited for. It stops by itself once it sees the deserializer
+	 * is not active anymore.
+	 */
+	cancel_delayed_work(&priv->link_monitor);
+	priv->healthy_links = 0;
+	priv->lost_links = 0;
+}
+
+static void max_des_update_telemetry(struct max_des_priv *priv)
+{
+	struct max_des *des = priv->des;
+
+	if (des->active == priv->telemetry_running)
+		return;
+
+	priv->telemetry_running = des->active;
+
+	if (!des->active) {
+		cancel_delayed_work_sync(&priv->telemetry_work);
+		return;
+	}
+
+	memset(&priv->telemetry_last, 0, sizeof(priv->telemetry_last));
+
+	if (priv->telemetry_interval_ms)
+		schedule_delayed_work(&priv->telemetry_work,
+				      msecs_to_jiffies(priv->telemetry_interval_ms));
+}
+
+/*
+ * Arm frame sync once every link with routes is streaming, so that all
+ * sensors receive their first frame sync pulse at the same time.
+ */
+static void max_des_update_fsync_armed(struct max_des_priv *priv,
+				       struct v4l2_subdev_state *state)
+{
+	struct max_des *des = priv->des;
+	struct v4l2_subdev_route *route;
+	unsigned long streaming_links = 0;
+	unsigned long routed_links = 0;
+	unsigned int i;
+	int ret;
+
+	if (!priv->fsync_mode_ctrl)
+		return;
+
+	for_each_active_route(&state->routing, route)
+		if (max_des_pad_is_sink(des, route->sink_pad))
+			routed_links |= BIT(route->sink_pad);
+
+	for (i = 0; i < des->ops->num_pipes; i++) {
+		struct max_des_pipe *pipe = &des->pipes[i];
+
+		if (pipe->enabled)
+			streaming_links |= BIT(pipe->link_id);
+	}
+
+	v4l2_ctrl_lock(priv->fsync_mode_ctrl);
+
+	priv->fsync_armed = routed_links && routed_links == streaming_links;
+
+	ret = max_des_update_fsync(priv);
+	if (ret)
+		dev_err(priv->dev, "Failed to update frame sync: %d\n", ret);
+
+	v4l2_ctrl_unlock(priv->fsync_mode_ctrl);
+}
+
+static int max_des_update_streams(struct v4l2_subdev *sd,
+				  struct v4l2_subdev_state *state,
+				  u32 pad, u64 updated_streams_mask, bool enable)
+{
+	struct max_des_priv *priv = v4l2_get_subdevdata(sd);
+	struct max_des_remap_context context = { 0 };
+	struct max_des_mode_context mode_context = { 0 };
+	struct max_des *des = priv->des;
+	unsigned int num_pads = max_des_num_pads(des);
+	struct max_des_bw bw;
+	u64 *streams_masks;
+	int ret;
+
+	ret = max_des_populate_remap_context(priv, &context, state);
+	if (ret)
+		return ret;
+
+	priv->grouped_start = v4l2_ctrl_g_ctrl(priv->grouped_start_ctrl);
+
+	ret = max_des_populate_mode_context(priv, &mode_context, state, context.mode);
+	if (ret)
+		return ret;
+
+	ret = max_serdes_get_streams_masks(priv->dev, state, pad, updated_streams_mask,
+					   num_pads, priv->streams_masks, &streams_masks,
+					   enable);
+	if (ret)
+		return ret;
+
+	ret = max_des_get_bw(priv, state, streams_masks, &bw);
+	if (ret)
+		goto err_free_streams_masks;
+
+	if (enable) {
+		ret = max_des_check_bw(priv, &bw);
+		if (!ret)
+			ret = max_des_check_link_freqs(priv, &bw);
+		if (ret) {
+			dev_err(priv->dev, "Not enough bandwidth for streams\n");
+			goto err_free_streams_masks;
+		}
+
+		ret = max_des_apply_link_freqs(priv);
+		if (ret)
+			goto err_free_streams_masks;
+	}
+
+	ret = max_des_set_pipes_phy(priv, &context);
+	if (ret)
+		goto err_free_streams_masks;
+
+	ret = max_des_set_tunnel(priv, &context);
+	if (ret)
+		goto err_free_streams_masks;
+
+	ret = max_des_set_modes(priv, &mode_context);
+	if (ret)
+		goto err_free_streams_masks;
+
+	ret = max_des_set_vc_remaps(priv, &context, state, streams_masks);
+	if (ret)
+		return ret;
+
+	ret = max_des_set_pipes_stream_id(priv);
+	if (ret)
+		goto err_free_streams_masks;
+
+	if (!enable) {
+		/* The work never takes the state lock, waiting on it is safe. */
+		cancel_delayed_work_sync(&priv->start_skew_work);
+
+		ret = max_des_enable_disable_streams(priv, priv->streams_masks,
+						     streams_masks, enable);
+		if (ret)
+			goto err_free_streams_masks;
+	}
+
+	ret = max_des_update_active(priv, streams_masks, false);
+	if (ret)
+		goto err_revert_streams_disable;
+
+	ret = max_des_update_links(priv, &context, state, streams_masks);
+	if (ret)
+		goto err_revert_active_disable;
+
+	ret = max_des_update_tpg(priv, state, streams_masks);
+	if (ret)
+		goto err_revert_links_update;
+
+	ret = max_des_update_active(priv, streams_masks, true);
+	if (ret)
+		goto err_revert_tpg_update;
+
+	if (enable) {
+		ret = max_des_enable_disable_streams(priv, priv->streams_masks,
+						     streams_masks, enable);
+		if (ret)
+			goto err_revert_active_enable;
+	}
+
+	if (!priv->grouped_start ||
+	    max_des_all_streams_enabled(state, streams_masks)) {
+		ret = max_des_release_pipes(priv, priv->held_pipes);
+		if (ret)
+			goto err_revert_streams_enable;
+	}
+
+	devm_kfree(priv->dev, priv->streams_masks);
+	priv->streams_masks = streams_masks;
+	priv->bw = bw;
+
+	max_des_update_link_monitor(priv);
+	max_des_update_telemetry(priv);
+	max_des_update_fsync_armed(priv, state);
+
+	return 0;
+
+err_revert_streams_enable:
+	if (enable)
+		max_des_enable_disable_streams(priv, streams_masks,
+					       priv->streams_masks, !enable);
+
+err_revert_active_enable:
+	max_des_update_active(priv, priv->streams_masks, false);
+
+err_revert_tpg_update:
+	max_des_update_tpg(priv, state, priv->streams_masks);
+
+err_revert_links_update:
+	max_des_update_links(priv, &context, state, priv->streams_masks);
+
+err_revert_active_disable:
+	max_des_update_active(priv, priv->streams_masks, true);
+
+err_revert_streams_disable:
+	if (!enable)
+		max_des_enable_disable_streams(priv, streams_masks,
+					       priv->streams_masks, !enable);
+
+err_free_streams_masks:
+	devm_kfree(priv->dev, streams_masks);
+
+	return ret;
+}
+
+static int max_des_enable_streams(struct v4l2_subdev *sd,
+				  struct v4l2_subdev_state *state,
+				  u32 pad, u64 streams_mask)
+{
+	return max_des_update_streams(sd, state, pad, streams_mask, true);
+}
+
+static int max_des_disable_streams(struct v4l2_subdev *sd,
+				   struct v4l2_subdev_state *state,
+				   u32 pad, u64 streams_mask)
+{
+	return max_des_update_streams(sd, state, pad, streams_mask, false);
+}
+
+static bool max_des_link_streaming(struct max_des_priv *priv,
+				   struct max_des_link *link)
+{
+	struct max_des *des = priv->des;
+	unsigned int i;
+
+	for (i = 0; i < des->ops->num_pipes; i++) {
+		struct max_des_pipe *pipe = &des->pipes[i];
+
+		if (pipe->link_id == link->index && pipe->enabled)
+			return true;
+	}
+
+	return false;
+}
+
+static int max_des_check_link(struct max_des_priv *priv,
+			      struct max_des_link *link,
+			      bool *link_locked, bool *video_locked)
+{
+	struct max_des *des = priv->des;
+	unsigned int i;
+	int ret;
+
+	*link_locked = true;
+	*video_locked = true;
+
+	if (des->ops->get_link_lock) {
+		ret = des->ops->get_link_lock(des, link, link_locked);
+		if (ret && ret != -EOPNOTSUPP)
+			return ret;
+	}
+
+	if (!*link_locked) {
+		*video_locked = false;
+		return 0;
+	}
+
+	if (!des->ops->get_pipe_video_lock)
+		return 0;
+
+	for (i = 0; i < des->ops->num_pipes; i++) {
+		struct max_des_pipe *pipe = &des->pipes[i];
+
+		if (pipe->link_id != link->index || !pipe->enabled)
+			continue;
+
+		ret = des->ops->get_pipe_video_lock(des, pipe, video_locked);
+		if (ret)
+			return ret;
+
+		if (!*video_locked)
+			return 0;
+	}
+
+	return 0;
+}
+
+static void max_des_notify_link_lock(struct max_des_priv *priv,
+				     struct max_des_link *link, bool locked)
+{
+	struct v4l2_event ev = {
+		.type = MAX_SERDES_EVENT_LINK_LOCK,
+		.id = max_des_link_to_pad(priv->des, link),
+	};
+
+	ev.u.data[0] = locked;
+
+	v4l2_subdev_notify_event(&priv->sd, &ev);
+}
+
+static int max_des_link_enable_disable_streams(struct max_des_priv *priv,
+					       struct max_des_link *link,
+					       bool enable)
+{
+	u32 pad = max_des_link_to_pad(priv->des, link);
+
+	if (!priv->streams_masks[pad])
+		return 0;
+
+	return max_des_source_enable_disable_streams(priv, pad,
+						     priv->streams_masks[pad],
+						     enable);
+}
+
+static int max_des_recover_link(struct max_des_priv *priv,
+				struct v4l2_subdev_state *state,
+				struct max_des_link *link, bool link_locked)
+{
+	struct max_des_remap_context context = { 0 };
+	struct max_des *des = priv->des;
+	struct max_des_link_hw hw;
+	unsigned long pipes = 0;
+	unsigned int i;
+	int ret;
+
+	ret = max_des_link_to_hw(priv, link, &hw);
+	if (ret)
+		return ret;
+
+	if (!link_locked && des->ops->reset_link) {
+		ret = des->ops->reset_link(des, link);
+		if (ret && ret != -EOPNOTSUPP)
+			return ret;
+	}
+
+	ret = max_des_wait_link_lock(priv, link);
+	if (ret)
+		return ret;
+
+	priv->pipes_phy_applied = false;
+	priv->tunnel_applied = false;
+
+	ret = max_des_populate_remap_context(priv, &context, state);
+	if (ret)
+		return ret;
+
+	/*
+	 * Stop the serializer streams of this link, ignoring errors, since
+	 * the serializer may have lost its state together with the link.
+	 */
+	max_des_link_enable_disable_streams(priv, link, false);
+
+	if (hw.source->sd) {
+		ret = max_ser_restore(hw.source->sd);
+		if (ret)
+			return ret;
+	}
+
+	/* Disable the pipes of this link so that they are fully re-applied. */
+	for (i = 0; i < des->ops->num_pipes; i++) {
+		struct max_des_pipe *pipe = &des->pipes[i];
+
+		if (pipe->link_id != link->index || !pipe->enabled)
+			continue;
+
+		ret = des->ops->set_pipe_enable(des, pipe, false);
+		if (ret)
+			return ret;
+
+		pipe->enabled = false;
+		pipes |= BIT(i);
+	}
+
+	ret = max_des_update_link(priv, &context, link, state,
+				  priv->streams_masks);
+	if (ret)
+		return ret;
+
+	/* Only the restored serializer misses its configuration. */
+	ret = max_des_set_tunnel(priv, &context);
+	if (ret)
+		return ret;
 
-	ret = max_des_set_vc_remaps(priv, &context, state, streams_masks);
+	ret = max_des_set_vc_remaps(priv, &context, state, priv->streams_masks);
 	if (ret)
 		return ret;
 
 	ret = max_des_set_pipes_stream_id(priv);
 	if (ret)
-		goto err_free_streams_masks;
-
-	if (!enable) {
-		ret = max_des_enable_disable_streams(priv, state, pad,
-						     updated_streams_mask, enable);
-		if (ret)
-			goto err_free_streams_masks;
-	}
+		return ret;
 
-	ret = max_des_update_active(priv, streams_masks, false);
+	ret = max_des_link_enable_disable_streams(priv, link, true);
 	if (ret)
-		goto err_revert_streams_disable;
+		return ret;
 
-	ret = max_des_update_links(priv, &context, state, streams_masks);
-	if (ret)
-		goto err_revert_active_disable;
+	/* In grouped start mode, the re-applied pipes are held, release them. */
+	return max_des_release_pipes(priv, pipes);
+}
 
-	ret = max_des_update_tpg(priv, state, streams_masks);
-	if (ret)
-		goto err_revert_links_update;
+static void max_des_link_monitor_work(struct work_struct *work)
+{
+	struct max_des_priv *priv = container_of(to_delayed_work(work),
+						 struct max_des_priv,
+						 link_monitor);
+	struct max_des *des = priv->des;
+	struct v4l2_subdev_state *state;
+	unsigned int i;
+	int ret;
 
-	ret = max_des_update_active(priv, streams_masks, true);
-	if (ret)
-		goto err_revert_tpg_update;
+	state = v4l2_subdev_lock_and_get_active_state(&priv->sd);
 
-	if (enable) {
-		ret = max_des_enable_disable_streams(priv, state, pad,
-						     updated_streams_mask, enable);
-		if (ret)
-			goto err_revert_active_enable;
-	}
+	if (!des->active)
+		goto out_unlock;
 
-	devm_kfree(priv->dev, priv->streams_masks);
-	priv->streams_masks = streams_masks;
+	for (i = 0; i < des->ops->num_links; i++) {
+		struct max_des_link *link = &des->links[i];
+		bool link_locked = false;
+		bool video_locked;
 
-	return 0;
+		/*
+		 * Lost links are recovered even if their pipes ended up
+		 * disabled by a failed recovery attempt.
+		 */
+		if (!test_bit(i, &priv->lost_links)) {
+			if (!max_des_link_streaming(priv, link)) {
+				clear_bit(i, &priv->healthy_links);
+				continue;
+			}
 
-err_revert_active_enable:
-	max_des_update_active(priv, priv->streams_masks, false);
+			ret = max_des_check_link(priv, link, &link_locked,
+						 &video_locked);
+			if (ret) {
+				dev_dbg(priv->dev, "Failed to check link %u: %d\n",
+					i, ret);
+				continue;
+			}
 
-err_revert_tpg_update:
-	max_des_update_tpg(priv, state, priv->streams_masks);
+			if (link_locked && video_locked) {
+				set_bit(i, &priv->healthy_links);
+				continue;
+			}
 
-err_revert_links_update:
-	max_des_update_links(priv, &context, state, priv->streams_masks);
+			/*
+			 * Video takes a while to lock after streaming starts,
+			 * only links that have been healthy can be lost.
+			 */
+			if (!test_and_clear_bit(i, &priv->healthy_links))
+				continue;
 
-err_revert_active_disable:
-	max_des_update_active(priv, priv->streams_masks, true);
+			dev_warn(priv->dev, "Link %u lost %s lock\n", i,
+				 link_locked ? "video" : "link");
 
-err_revert_streams_disable:
-	if (!enable)
-		max_des_enable_disable_streams(priv, state, pad,
-					       updated_streams_mask, !enable);
+			set_bit(i, &priv->lost_links);
+			max_des_notify_link_lock(priv, link, false);
+		}
 
-err_free_streams_masks:
-	devm_kfree(priv->dev, streams_masks);
+		ret = max_des_recover_link(priv, state, link, link_locked);
+		if (ret) {
+			dev_dbg(priv->dev, "Failed to recover link %u: %d\n",
+				i, ret);
+			continue;
+		}
 
-	return ret;
-}
+		clear_bit(i, &priv->lost_links);
+		dev_info(priv->dev, "Link %u recovered\n", i);
+		max_des_notify_link_lock(priv, link, true);
+	}
 
-static int max_des_enable_streams(struct v4l2_subdev *sd,
-				  struct v4l2_subdev_state *state,
-				  u32 pad, u64 streams_mask)
-{
-	return max_des_update_streams(sd, state, pad, streams_mask, true);
-}
+	schedule_delayed_work(&priv->link_monitor,
+			      msecs_to_jiffies(MAX_DES_LINK_MONITOR_MS));
 
-static int max_des_disable_streams(struct v4l2_subdev *sd,
-				   struct v4l2_subdev_state *state,
-				   u32 pad, u64 streams_mask)
-{
-	return max_des_update_streams(sd, state, pad, streams_mask, false);
+out_unlock:
+	v4l2_subdev_unlock_state(state);
 }
 
 static int max_des_init_state(struct v4l2_subdev *sd,
@@ -2702,8 +4286,121 @@ static int max_des_s_register(struct v4l2_subdev *sd,
 }
 #endif
 
+static void max_des_telemetry_sample(struct max_des_priv *priv,
+				     struct max_des_telemetry_record *rec)
+{
+	struct max_des *des = priv->des;
+	unsigned int i;
+	int ret;
+
+	rec->timestamp_ns = ktime_get_boottime_ns();
+	rec->link_locked = 0;
+	rec->pipe_video_locked = 0;
+	rec->pipe_overflow = 0;
+
+	for (i = 0; i < des->ops->num_links; i++) {
+		struct max_des_link *link = &des->links[i];
+		struct max_des_link_stats stats;
+		bool locked;
+
+		if (!link->enabled)
+			continue;
+
+		if (des->ops->get_link_lock &&
+		    !des->ops->get_link_lock(des, link, &locked) && locked)
+			rec->link_locked |= BIT(i);
+
+		if (!des->ops->get_link_stats)
+			continue;
+
+		ret = des->ops->get_link_stats(des, link, &stats);
+		if (ret) {
+			if (ret != -EOPNOTSUPP)
+				dev_dbg(priv->dev, "Failed to get link %u stats: %d\n",
+					i, ret);
+			continue;
+		}
+
+		rec->link_dec_err[i] += stats.dec_err;
+		rec->link_idle_err[i] += stats.idle_err;
+	}
+
+	for (i = 0; i < des->ops->num_pipes; i++) {
+		struct max_des_pipe *pipe = &des->pipes[i];
+		bool locked;
+
+		if (!pipe->enabled || !des->ops->get_pipe_video_lock)
+			continue;
+
+		if (!des->ops->get_pipe_video_lock(des, pipe, &locked) && locked)
+			rec->pipe_video_locked |= BIT(i);
+	}
+
+	if (des->ops->get_pipes_overflow) {
+		unsigned long pipes;
+
+		ret = des->ops->get_pipes_overflow(des, &pipes);
+		if (!ret)
+			rec->pipe_overflow = pipes;
+		else
+			dev_dbg(priv->dev, "Failed to get pipes overflow: %d\n", ret);
+	}
+
+	for (i = 0; i < des->ops->num_phys; i++) {
+		struct max_des_phy *phy = &des->phys[i];
+		struct max_des_phy_stats stats;
+
+		if (!phy->enabled || !des->ops->get_phy_stats)
+			continue;
+
+		ret = des->ops->get_phy_stats(des, phy, &stats);
+		if (ret)
+			continue;
+
+		rec->phy_csi2_pkt_cnt[i] = stats.csi2_pkt_cnt;
+		rec->phy_pkt_cnt[i] = stats.phy_pkt_cnt;
+	}
+}
+
+static void max_des_telemetry_work(struct work_struct *work)
+{
+	struct max_des_priv *priv = container_of(to_delayed_work(work),
+						 struct max_des_priv,
+						 telemetry_work);
+
+	/*
+	 * Only this worker updates the last record, the lock protects the
+	 * ring against readers.
+	 */
+	max_des_telemetry_sample(priv, &priv->telemetry_last);
+
+	mutex_lock(&priv->telemetry_lock);
+
+	priv->telemetry[priv->telemetry_head] = priv->telemetry_last;
+	priv->telemetry_head = (priv->telemetry_head + 1) % MAX_DES_TELEMETRY_RECORDS;
+	if (priv->telemetry_count < MAX_DES_TELEMETRY_RECORDS)
+		priv->telemetry_count++;
+
+	mutex_unlock(&priv->telemetry_lock);
+
+	if (priv->telemetry_interval_ms)
+		schedule_delayed_work(&priv->telemetry_work,
+				      msecs_to_jiffies(priv->telemetry_interval_ms));
+}
+
+static int max_des_subscribe_event(struct v4l2_subdev *sd, struct v4l2_fh *fh,
+				   struct v4l2_event_subscription *sub)
+{
+	if (sub->type == MAX_SERDES_EVENT_LINK_LOCK)
+		return v4l2_event_subscribe(fh, sub, MAX_DES_NUM_LINKS, NULL);
+
+	return v4l2_ctrl_subdev_subscribe_event(sd, fh, sub);
+}
+
 static const struct v4l2_subdev_core_ops max_des_core_ops = {
 	.log_status = max_des_log_status,
+	.subscribe_event = max_des_subscribe_event,
+	.unsubscribe_event = v4l2_event_subdev_unsubscribe,
 #ifdef CONFIG_VIDEO_ADV_DEBUG
 	.g_register = max_des_g_register,
 	.s_register = max_des_s_register,
@@ -2714,6 +4411,39 @@ static const struct v4l2_ctrl_ops max_des_ctrl_ops = {
 	.s_ctrl = max_des_s_ctrl,
 };
 
+static const struct v4l2_ctrl_config max_des_fsync_mode_ctrl = {
+	.ops = &max_des_ctrl_ops,
+	.id = MAX_SERDES_CID_FSYNC_MODE,
+	.name = "Frame Sync Mode",
+	.type = V4L2_CTRL_TYPE_MENU,
+	.max = ARRAY_SIZE(max_des_fsync_modes) - 1,
+	.def = MAX_DES_FSYNC_MODE_DISABLED,
+	.qmenu = max_des_fsync_modes,
+};
+
+/* A period of 0 derives it from the frame interval of the sensors. */
+static const struct v4l2_ctrl_config max_des_fsync_period_ctrl = {
+	.ops = &max_des_ctrl_ops,
+	.id = MAX_SERDES_CID_FSYNC_PERIOD,
+	.name = "Frame Sync Period (us)",
+	.type = V4L2_CTRL_TYPE_INTEGER,
+	.min = 0,
+	.max = MAX_DES_FSYNC_PERIOD_MAX_US,
+	.step = 1,
+	.def = 0,
+};
+
+static const struct v4l2_ctrl_config max_des_grouped_start_ctrl = {
+	.ops = &max_des_ctrl_ops,
+	.id = MAX_SERDES_CID_GROUPED_START,
+	.name = "Grouped Stream Start",
+	.type = V4L2_CTRL_TYPE_BOOLEAN,
+	.min = 0,
+	.max = 1,
+	.step = 1,
+	.def = 0,
+};
+
 static const struct v4l2_subdev_pad_ops max_des_pad_ops = {
 	.enable_streams = max_des_enable_streams,
 	.disable_streams = max_des_disable_streams,
@@ -2864,7 +4594,8 @@ static int max_des_v4l2_register(struct max_des_priv *priv)
 	sd->internal_ops = &max_des_internal_ops;
 	sd->entity.function = MEDIA_ENT_F_VID_IF_BRIDGE;
 	sd->entity.ops = &max_des_media_ops;
-	sd->flags |= V4L2_SUBDEV_FL_HAS_DEVNODE | V4L2_SUBDEV_FL_STREAMS;
+	sd->flags |= V4L2_SUBDEV_FL_HAS_DEVNODE | V4L2_SUBDEV_FL_HAS_EVENTS |
+		     V4L2_SUBDEV_FL_STREAMS;
 
 	for (i = 0; i < num_pads; i++) {
 		if (max_des_pad_is_sink(des, i))
@@ -2881,24 +4612,39 @@ static int max_des_v4l2_register(struct max_des_priv *priv)
 	v4l2_set_subdevdata(sd, priv);
 
 	/* Initialize control handler - always create for link_freq */
-	v4l2_ctrl_handler_init(&priv->ctrl_handler, 2);
+	v4l2_ctrl_handler_init(&priv->ctrl_handler, 5);
 	priv->sd.ctrl_handler = &priv->ctrl_handler;
 
 	/* Add link frequency control from first enabled phy */
 	/* This is needed by IPU7 CSI2 driver to configure the PHY */
 	for (i = 0; i < des->ops->num_phys; i++) {
-		if (des->phys[i].enabled) {
-			priv->link_freq_menu[0] = des->phys[i].link_frequency;
-
-			priv->link_freq_ctrl = v4l2_ctrl_new_int_menu(&priv->ctrl_handler,
-								       &max_des_ctrl_ops,
-								       V4L2_CID_LINK_FREQ,
-								       0, 0,
-								       priv->link_freq_menu);
-			if (priv->link_freq_ctrl)
-				priv->link_freq_ctrl->flags |= V4L2_CTRL_FLAG_READ_ONLY;
-			break;
-		}
+		struct max_des_phy *phy = &des->phys[i];
+		u64 max_freq = priv->phys_max_link_frequency[i];
+		u64 freq;
+
+		if (!phy->enabled)
+			continue;
+
+		/*
+		 * Offer every frequency the link frequency can be lowered to,
+		 * ending with the one from firmware.
+		 */
+		for (freq = MAX_DES_LINK_FREQUENCY_MIN; freq < max_freq;
+		     freq += MAX_DES_LINK_FREQUENCY_STEP)
+			priv->link_freq_menu[priv->num_link_freqs++] = freq;
+
+		priv->link_freq_menu[priv->num_link_freqs++] = max_freq;
+		priv->link_freq_phy = phy;
+
+		priv->link_freq_ctrl = v4l2_ctrl_new_int_menu(&priv->ctrl_handler,
+							       &max_des_ctrl_ops,
+							       V4L2_CID_LINK_FREQ,
+							       priv->num_link_freqs - 1,
+							       priv->num_link_freqs - 1,
+							       priv->link_freq_menu);
+		if (priv->link_freq_ctrl)
+			priv->link_freq_ctrl->flags |= V4L2_CTRL_FLAG_READ_ONLY;
+		break;
 	}
 
 	if (des->ops->tpg_patterns) {
@@ -2911,6 +4657,19 @@ static int max_des_v4l2_register(struct max_des_priv *priv)
 					     max_serdes_tpg_patterns);
 	}
 
+	if (des->ops->set_fsync && priv->fsync_tx_id != MAX_DES_FSYNC_TX_ID_NONE) {
+		priv->fsync_mode_ctrl = v4l2_ctrl_new_custom(&priv->ctrl_handler,
+							     &max_des_fsync_mode_ctrl,
+							     NULL);
+		priv->fsync_period_ctrl = v4l2_ctrl_new_custom(&priv->ctrl_handler,
+							       &max_des_fsync_period_ctrl,
+							       NULL);
+	}
+
+	priv->grouped_start_ctrl = v4l2_ctrl_new_custom(&priv->ctrl_handler,
+							&max_des_grouped_start_ctrl,
+							NULL);
+
 	if (priv->ctrl_handler.error) {
 		ret = priv->ctrl_handler.error;
 		goto err_free_ctrl;
@@ -3105,6 +4864,8 @@ static int max_des_parse_src_dt_endpoint(struct max_des_priv *priv,
 	phy->link_frequency = link_frequency;
 	phy->enabled = true;
 
+	priv->phys_max_link_frequency[phy->index] = link_frequency;
+
 	return 0;
 }
 
@@ -3175,6 +4936,10 @@ static int max_des_parse_dt(struct max_des_priv *priv)
 	if (!fwnode_property_read_u32(fwnode, "pipe-stream-autoselect", &val))
 		des->pipe_stream_autoselect = !!val;
 
+	priv->fsync_tx_id = MAX_DES_FSYNC_TX_ID_NONE;
+	if (!fwnode_property_read_u32(fwnode, "maxim,fsync-tx-id", &val))
+		priv->fsync_tx_id = val;
+
 	for (i = 0; i < des->ops->num_phys; i++) {
 		phy = &des->phys[i];
 		phy->index = i;
@@ -3286,9 +5051,187 @@ static int max_des_allocate(struct max_des_priv *priv)
 	if (!priv->streams_masks)
 		return -ENOMEM;
 
+	priv->telemetry = devm_kcalloc(priv->dev, MAX_DES_TELEMETRY_RECORDS,
+				       sizeof(*priv->telemetry), GFP_KERNEL);
+	if (!priv->telemetry)
+		return -ENOMEM;
+
+	return 0;
+}
+
+static int max_des_bandwidth_show(struct seq_file *s, void *data)
+{
+	struct max_des_priv *priv = s->private;
+	struct max_des *des = priv->des;
+	struct v4l2_subdev_state *state;
+	unsigned int i;
+	u64 bps;
+
+	state = v4l2_subdev_lock_and_get_active_state(&priv->sd);
+
+	for (i = 0; i < des->ops->num_links; i++) {
+		struct max_des_link *link = &des->links[i];
+
+		if (!link->enabled)
+			continue;
+
+		bps = link->ser_xlate.en ? max_serdes_gmsl_version_bps(link->version) : 0;
+
+		seq_printf(s, "link %u: %llu / %llu bps (%llu%%)\n", link->index,
+			   priv->bw.links[i], bps,
+			   bps ? div64_u64(priv->bw.links[i] * 100, bps) : 0);
+	}
+
+	for (i = 0; i < des->ops->num_pipes; i++) {
+		struct max_des_pipe *pipe = &des->pipes[i];
+
+		seq_printf(s, "pipe %u: %llu bps (link %u)\n", pipe->index,
+			   priv->bw.pipes[i], pipe->link_id);
+	}
+
+	for (i = 0; i < des->ops->num_phys; i++) {
+		struct max_des_phy *phy = &des->phys[i];
+
+		if (!phy->enabled)
+			continue;
+
+		bps = max_des_phy_bps(phy, phy->link_frequency);
+
+		seq_printf(s, "phy %u: %llu / %llu bps (%llu%%)\n", phy->index,
+			   priv->bw.phys[i], bps,
+			   bps ? div64_u64(priv->bw.phys[i] * 100, bps) : 0);
+	}
+
+	v4l2_subdev_unlock_state(state);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(max_des_bandwidth);
+
+static int max_des_start_skew_show(struct seq_file *s, void *data)
+{
+	struct max_des_priv *priv = s->private;
+	struct max_des *des = priv->des;
+	unsigned int i;
+
+	mutex_lock(&priv->start_skew_lock);
+
+	for_each_set_bit(i, &priv->start_locked_pipes, des->ops->num_pipes)
+		seq_printf(s, "pipe %u: %lld us\n", i, priv->start_lock_us[i]);
+
+	seq_printf(s, "skew: %lld us\n", priv->start_skew_us);
+
+	mutex_unlock(&priv->start_skew_lock);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(max_des_start_skew);
+
+struct max_des_telemetry_snapshot {
+	size_t size;
+	struct max_des_telemetry_record records[MAX_DES_TELEMETRY_RECORDS];
+};
+
+/*
+ * Each open takes a snapshot of the telemetry ring, oldest record first,
+ * so that readers see a consistent stream of records.
+ */
+static int max_des_telemetry_open(struct inode *inode, struct file *file)
+{
+	struct max_des_priv *priv = inode->i_private;
+	struct max_des_telemetry_snapshot *snapshot;
+	unsigned int start, i;
+
+	snapshot = kvzalloc(sizeof(*snapshot), GFP_KERNEL);
+	if (!snapshot)
+		return -ENOMEM;
+
+	mutex_lock(&priv->telemetry_lock);
+
+	start = priv->telemetry_head + MAX_DES_TELEMETRY_RECORDS -
+		priv->telemetry_count;
+
+	for (i = 0; i < priv->telemetry_count; i++)
+		snapshot->records[i] =
+			priv->telemetry[(start + i) % MAX_DES_TELEMETRY_RECORDS];
+
+	snapshot->size = priv->telemetry_count * sizeof(snapshot->records[0]);
+
+	mutex_unlock(&priv->telemetry_lock);
+
+	file->private_data = snapshot;
+
+	return 0;
+}
+
+static ssize_t max_des_telemetry_read(struct file *file, char __user *buf,
+				      size_t count, loff_t *ppos)
+{
+	struct max_des_telemetry_snapshot *snapshot = file->private_data;
+
+	return simple_read_from_buffer(buf, count, ppos, snapshot->records,
+				       snapshot->size);
+}
+
+static int max_des_telemetry_release(struct inode *inode, struct file *file)
+{
+	kvfree(file->private_data);
+
+	return 0;
+}
+
+static const struct file_operations max_des_telemetry_fops = {
+	.owner = THIS_MODULE,
+	.open = max_des_telemetry_open,
+	.read = max_des_telemetry_read,
+	.release = max_des_telemetry_release,
+	.llseek = default_llseek,
+};
+
+static int max_des_telemetry_interval_get(void *data, u64 *val)
+{
+	struct max_des_priv *priv = data;
+
+	*val = priv->telemetry_interval_ms;
+
+	return 0;
+}
+
+/*
+ * Every sample reads a handful of registers, keep sampling from eating into
+ * the I2C bandwidth the serializers and sensors need. 0 stops sampling until
+ * the next stream start.
+ */
+static int max_des_telemetry_interval_set(void *data, u64 val)
+{
+	struct max_des_priv *priv = data;
+
+	if (val)
+		val = clamp_val(val, MAX_DES_TELEMETRY_INTERVAL_MIN_MS, U32_MAX);
+
+	priv->telemetry_interval_ms = val;
+
 	return 0;
 }
 
+DEFINE_SIMPLE_ATTRIBUTE(max_des_telemetry_interval_fops,
+			max_des_telemetry_interval_get,
+			max_des_telemetry_interval_set, "%llu\n");
+
+static void max_des_debugfs_init(struct max_des_priv *priv)
+{
+	priv->debugfs = debugfs_create_dir(dev_name(priv->dev), NULL);
+
+	debugfs_create_file("bandwidth", 0444, priv->debugfs, priv,
+			    &max_des_bandwidth_fops);
+	debugfs_create_file("telemetry", 0400, priv->debugfs, priv,
+			    &max_des_telemetry_fops);
+	debugfs_create_file("start_skew", 0400, priv->debugfs, priv,
+			    &max_des_start_skew_fops);
+	debugfs_create_file("telemetry_interval_ms", 0600, priv->debugfs, priv,
+			    &max_des_telemetry_interval_fops);
+}
+
 int max_des_probe(struct i2c_client *client, struct max_des *des)
 {
 	struct device *dev = &client->dev;
@@ -3328,6 +5271,13 @@ int max_des_probe(struct i2c_client *client, struct max_des *des)
 	priv->des = des;
 	des->priv = priv;
 
+	INIT_DELAYED_WORK(&priv->link_monitor, max_des_link_monitor_work);
+	INIT_DELAYED_WORK(&priv->telemetry_work, max_des_telemetry_work);
+	mutex_init(&priv->telemetry_lock);
+	INIT_DELAYED_WORK(&priv->start_skew_work, max_des_start_skew_work);
+	mutex_init(&priv->start_skew_lock);
+	priv->telemetry_interval_ms = MAX_DES_TELEMETRY_INTERVAL_MS;
+
 	ret = max_des_allocate(priv);
 	if (ret)
 		return ret;
@@ -3357,6 +5307,8 @@ int max_des_probe(struct i2c_client *client, struct max_des *des)
 	if (ret)
 		goto err_i2c_adapter_deinit;
 
+	max_des_debugfs_init(priv);
+
 	return 0;
 
 err_i2c_adapter_deinit:
@@ -3373,6 +5325,12 @@ int max_des_remove(struct max_des *des)
 {
 	struct max_des_priv *priv = des->priv;
 
+	debugfs_remove_recursive(priv->debugfs);
+
+	cancel_delayed_work_sync(&priv->link_monitor);
+	cancel_delayed_work_sync(&priv->telemetry_work);
+	cancel_delayed_work_sync(&priv->start_skew_work);
+
 	max_des_v4l2_unregister(priv);
 
 	max_des_i2c_adapter_deinit(priv);
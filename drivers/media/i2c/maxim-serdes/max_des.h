@@ -20,6 +20,23 @@ struct max_des_remap {
 	u8 phy;
 };
 
+struct max_des_link_stats {
+	u32 dec_err;
+	u32 idle_err;
+};
+
+struct max_des_phy_stats {
+	u32 csi2_pkt_cnt;
+	u32 phy_pkt_cnt;
+};
+
+struct max_des_fsync {
+	bool enable;
+	unsigned int period_us;
+	unsigned int links;
+	unsigned int tx_id;
+};
+
 struct max_des_link {
 	unsigned int index;
 	bool enabled;
@@ -72,6 +89,7 @@ struct max_des_ops {
 	unsigned int num_pipes;
 	unsigned int num_links;
 	unsigned int num_remaps_per_pipe;
+	unsigned int num_vc_ids;
 	unsigned int versions;
 	unsigned int modes;
 	bool fix_tx_ids;
@@ -109,6 +127,8 @@ struct max_des_ops {
 				   struct max_des_phy *phy);
 	int (*set_pipe_enable)(struct max_des *des, struct max_des_pipe *pipe,
 			       bool enable);
+	int (*set_pipes_enable)(struct max_des *des, unsigned int mask,
+				bool enable);
 	int (*set_pipe_remap)(struct max_des *des, struct max_des_pipe *pipe,
 			      unsigned int i, struct max_des_remap *remap);
 	int (*set_pipe_remaps_enable)(struct max_des *des, struct max_des_pipe *pipe,
@@ -125,6 +145,17 @@ struct max_des_ops {
 	int (*select_links)(struct max_des *des, unsigned int mask);
 	int (*set_link_version)(struct max_des *des, struct max_des_link *link,
 				enum max_serdes_gmsl_version version);
+	int (*get_link_lock)(struct max_des *des, struct max_des_link *link,
+			     bool *locked);
+	int (*get_pipe_video_lock)(struct max_des *des, struct max_des_pipe *pipe,
+				   bool *locked);
+	int (*reset_link)(struct max_des *des, struct max_des_link *link);
+	int (*get_link_stats)(struct max_des *des, struct max_des_link *link,
+			      struct max_des_link_stats *stats);
+	int (*get_phy_stats)(struct max_des *des, struct max_des_phy *phy,
+			     struct max_des_phy_stats *stats);
+	int (*get_pipes_overflow)(struct max_des *des, unsigned long *pipes);
+	int (*set_fsync)(struct max_des *des, const struct max_des_fsync *fsync);
 };
 
 struct max_des_priv;
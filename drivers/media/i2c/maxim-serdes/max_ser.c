@@ -10,6 +10,7 @@
 #include <linux/bitfield.h>
 #include <linux/i2c-atr.h>
 #include <linux/i2c-mux.h>
+#include <linux/ktime.h>
 #include <linux/module.h>
 
 #include <media/mipi-csi2.h>
@@ -23,6 +24,10 @@
 #define MAX_SER_NUM_LINKS	1
 #define MAX_SER_NUM_PHYS	1
 
+#define MAX_SER_WAIT_POLL_MIN_US	1000
+#define MAX_SER_WAIT_POLL_MAX_US	100000
+#define MAX_SER_WAIT_TIMEOUT_US		1000000
+
 struct max_ser_priv {
 	struct max_ser *ser;
 	struct device *dev;
@@ -36,6 +41,13 @@ struct max_ser_priv {
 	u64 *streams_masks;
 	u32 double_bpps;
 
+	/*
+	 * Whether the stream id of the first pipe and ser->vc_remaps match
+	 * the hardware, in which case unchanged values are not rewritten.
+	 */
+	bool stream_id_applied;
+	bool vc_remaps_applied;
+
 	struct v4l2_subdev sd;
 	struct v4l2_async_notifier nf;
 	struct v4l2_ctrl_handler ctrl_handler;
@@ -379,11 +391,13 @@ static void max_ser_i2c_atr_detach_addr(struct i2c_atr *atr, u32 chan_id, u16 ad
 
 	/* Find index of matching I2C translation. */
 	for (i = 0; i < ser->ops->num_i2c_xlates; i++)
-		if (ser->i2c_xlates[i].dst == addr)
+		if (ser->i2c_xlates[i].en && ser->i2c_xlates[i].dst == addr)
 			break;
 
-	WARN_ON(i == ser->ops->num_i2c_xlates);
+	if (WARN_ON(i == ser->ops->num_i2c_xlates))
+		return;
 
+	/* The alias goes back to the pool, it must not translate anymore. */
 	ser->ops->set_i2c_xlate(ser, i, &xlate);
 	ser->i2c_xlates[i] = xlate;
 }
@@ -407,6 +421,7 @@ static int max_ser_i2c_atr_init(struct max_ser_priv *priv)
 		.chan_id = 0,
 		.bus_handle = dev_fwnode(priv->dev),
 	};
+	int ret;
 
 	if (!i2c_check_functionality(priv->client->adapter,
 				     I2C_FUNC_SMBUS_WRITE_BYTE_DATA))
@@ -419,7 +434,13 @@ static int max_ser_i2c_atr_init(struct max_ser_priv *priv)
 
 	i2c_atr_set_driver_data(priv->atr, priv);
 
-	return i2c_atr_add_adapter(priv->atr, &desc);
+	ret = i2c_atr_add_adapter(priv->atr, &desc);
+	if (ret)
+		return ret;
+
+	max_serdes_register_swnode_clients(priv->dev, desc.bus_handle);
+
+	return 0;
 }
 #endif
 static int max_ser_i2c_mux_select(struct i2c_mux_core *mux, u32 chan)
@@ -583,11 +604,12 @@ static int max_ser_log_status(struct v4l2_subdev *sd)
 	}
 	v4l2_info(sd, "i2c_xlates:\n");
 	for (i = 0; i < ser->ops->num_i2c_xlates; i++) {
+		if (!ser->i2c_xlates[i].en)
+			continue;
+
 		v4l2_info(sd, "\ten: %u, src: 0x%02x dst: 0x%02x\n",
 			  ser->i2c_xlates[i].en, ser->i2c_xlates[i].src,
 			  ser->i2c_xlates[i].dst);
-		if (!ser->i2c_xlates[i].en)
-			break;
 	}
 	v4l2_info(sd, "\n");
 	if (ser->ops->set_vc_remap) {
@@ -797,7 +819,7 @@ static int max_ser_set_tpg_routing(struct v4l2_subdev *sd,
 	struct v4l2_mbus_framefmt fmt = { 0 };
 	int ret;
 
-	ret = max_serdes_validate_tpg_routing(routing);
+	ret = max_serdes_validate_tpg_routing(routing, 1);
 	if (ret)
 		return ret;
 
@@ -860,6 +882,11 @@ static int max_ser_set_routing(struct v4l2_subdev *sd,
 	return __max_ser_set_routing(sd, state, routing);
 }
 
+static unsigned int max_ser_num_vc_ids(struct max_ser *ser)
+{
+	return ser->ops->num_vc_ids ?: MAX_SERDES_VC_ID_NUM;
+}
+
 static int max_ser_get_pipe_vcs_dts(struct max_ser_priv *priv,
 				    struct v4l2_subdev_state *state,
 				    struct max_ser_pipe *pipe,
@@ -895,7 +922,7 @@ static int max_ser_get_pipe_vcs_dts(struct max_ser_priv *priv,
 		vc = hw.entry.bus.csi2.vc;
 		dt = hw.entry.bus.csi2.dt;
 
-		if (vc >= MAX_SERDES_VC_ID_NUM)
+		if (vc >= max_ser_num_vc_ids(ser))
 			return -E2BIG;
 
 		*vcs |= BIT(vc);
@@ -937,7 +964,7 @@ static int max_ser_get_pipe_vcs_dts(struct max_ser_priv *priv,
 		vc = hw.entry.bus.csi2.vc;
 		dt = hw.entry.bus.csi2.dt;
 
-		if (vc >= MAX_SERDES_VC_ID_NUM)
+		if (vc >= max_ser_num_vc_ids(ser))
 			return -E2BIG;
 
 		if (!(*vcs & BIT(vc)))
@@ -995,7 +1022,9 @@ static int max_ser_get_pipe_mode(struct max_ser_priv *priv,
 		bpps |= BIT(bpp);
 	}
 
-	ret = max_serdes_process_bpps(priv->dev, bpps, priv->double_bpps, &doubled_bpp);
+	/* The deserializer decides on doubling, follow it. */
+	ret = max_serdes_process_bpps(priv->dev, bpps, priv->double_bpps, NULL,
+				      &doubled_bpp);
 	if (ret)
 		return ret;
 
@@ -1477,6 +1506,9 @@ static int max_ser_init(struct max_ser_priv *priv)
 	unsigned int i;
 	int ret;
 
+	priv->stream_id_applied = false;
+	priv->vc_remaps_applied = false;
+
 	if (ser->ops->init) {
 		ret = ser->ops->init(ser);
 		if (ret)
@@ -2021,11 +2053,24 @@ int max_ser_set_stream_id(struct v4l2_subdev *sd, unsigned int stream_id)
 	struct max_ser_priv *priv = sd_to_priv(sd);
 	struct max_ser *ser = priv->ser;
 	struct max_ser_pipe *pipe = &ser->pipes[0];
+	int ret;
 
 	if (!ser->ops->set_pipe_stream_id)
 		return -EOPNOTSUPP;
 
-	return ser->ops->set_pipe_stream_id(ser, pipe, stream_id);
+	if (priv->stream_id_applied && pipe->stream_id == stream_id)
+		return 0;
+
+	priv->stream_id_applied = false;
+
+	ret = ser->ops->set_pipe_stream_id(ser, pipe, stream_id);
+	if (ret)
+		return ret;
+
+	pipe->stream_id = stream_id;
+	priv->stream_id_applied = true;
+
+	return 0;
 }
 
 int max_ser_get_stream_id(struct v4l2_subdev *sd, unsigned int *stream_id)
@@ -2108,6 +2153,12 @@ int max_ser_set_vc_remaps(struct v4l2_subdev *sd,
 	if (num_vc_remaps > ser->ops->num_vc_remaps)
 		return -E2BIG;
 
+	if (priv->vc_remaps_applied && num_vc_remaps == ser->num_vc_remaps &&
+	    !memcmp(ser->vc_remaps, vc_remaps, num_vc_remaps * sizeof(*vc_remaps)))
+		return 0;
+
+	priv->vc_remaps_applied = false;
+
 	for (i = 0; i < num_vc_remaps; i++) {
 		ret = ser->ops->set_vc_remap(ser, i, &vc_remaps[i]);
 		if (ret)
@@ -2124,6 +2175,49 @@ int max_ser_set_vc_remaps(struct v4l2_subdev *sd,
 		ser->vc_remaps[i] = vc_remaps[i];
 
 	ser->num_vc_remaps = num_vc_remaps;
+	priv->vc_remaps_applied = true;
+
+	return 0;
+}
+
+/*
+ * Rewrite the serializer configuration after it may have been lost, e.g.
+ * together with its GMSL link. The streams must be disabled, the stream
+ * id and VC remaps are rewritten by the next max_ser_set_stream_id() and
+ * max_ser_set_vc_remaps() calls.
+ */
+int max_ser_restore(struct v4l2_subdev *sd)
+{
+	struct max_ser_priv *priv = sd_to_priv(sd);
+	struct max_ser *ser = priv->ser;
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < ser->ops->num_i2c_xlates; i++) {
+		if (!ser->i2c_xlates[i].en)
+			continue;
+
+		ret = ser->ops->set_i2c_xlate(ser, i, &ser->i2c_xlates[i]);
+		if (ret)
+			return ret;
+	}
+
+	ret = max_ser_init(priv);
+	if (ret)
+		return ret;
+
+	for (i = 0; i < ser->ops->num_phys; i++)
+		ser->phys[i].active = false;
+
+	for (i = 0; i < ser->ops->num_pipes; i++)
+		ser->pipes[i].enabled = false;
+
+	if (ser->ops->set_tunnel_enable &&
+	    ser->mode == MAX_SERDES_GMSL_TUNNEL_MODE) {
+		ret = ser->ops->set_tunnel_enable(ser, true);
+		if (ret)
+			return ret;
+	}
 
 	return 0;
 }
@@ -2192,26 +2286,47 @@ int max_ser_reset(struct i2c_adapter *adapter, u8 addr)
 	return max_ser_write_reg(adapter, addr, MAX_SER_CTRL0, val);
 }
 
+int max_ser_broadcast_reset(struct i2c_adapter *adapter, u8 addr)
+{
+	/*
+	 * Multiple serializers may answer at the same address, which makes
+	 * reading back CTRL0 unreliable. The rest of the register does not
+	 * matter since everything is reset anyway.
+	 */
+	return max_ser_write_reg(adapter, addr, MAX_SER_CTRL0,
+				 MAX_SER_CTRL0_RESET_ALL);
+}
+
 int max_ser_wait_for_multiple(struct i2c_adapter *adapter, u8 *addrs,
 			      unsigned int num_addrs, u8 *current_addr)
 {
-	unsigned int i, j;
+	unsigned int delay_us = MAX_SER_WAIT_POLL_MIN_US;
+	ktime_t timeout = ktime_add_us(ktime_get(), MAX_SER_WAIT_TIMEOUT_US);
+	unsigned int i;
 	int ret = 0;
 	u8 val;
 
-	for (i = 0; i < 10; i++) {
-		for (j = 0; j < num_addrs; j++) {
-			ret = max_ser_read_reg(adapter, addrs[j], MAX_SER_REG0, &val);
+	/*
+	 * Serializers usually answer within a few milliseconds after a reset
+	 * or an address change, start polling quickly and back off to keep
+	 * the bus quiet if it takes longer.
+	 */
+	while (true) {
+		for (i = 0; i < num_addrs; i++) {
+			ret = max_ser_read_reg(adapter, addrs[i], MAX_SER_REG0, &val);
 			if (!ret && val) {
-				*current_addr = addrs[j];
+				*current_addr = addrs[i];
 				return 0;
 			}
-
-			msleep(100);
 		}
-	}
 
-	return ret;
+		if (ktime_after(ktime_get(), timeout))
+			return ret ?: -ETIMEDOUT;
+
+		fsleep(delay_us);
+		delay_us = min_t(unsigned int, delay_us * 2,
+				 MAX_SER_WAIT_POLL_MAX_US);
+	}
 }
 
 int max_ser_wait(struct i2c_adapter *adapter, u8 addr)
@@ -63,6 +63,7 @@ struct max_ser_ops {
 	unsigned int num_phys;
 	unsigned int num_i2c_xlates;
 	unsigned int num_vc_remaps;
+	unsigned int num_vc_ids;
 	bool vs_independent;
 
 	struct max_serdes_phys_configs phys_configs;
@@ -140,8 +141,10 @@ int max_ser_set_stream_id(struct v4l2_subdev *sd, unsigned int stream_id);
 int max_ser_get_stream_id(struct v4l2_subdev *sd, unsigned int *stream_id);
 int max_ser_set_vc_remaps(struct v4l2_subdev *sd, struct max_serdes_vc_remap *vc_remaps,
 			  int num_vc_remaps);
+int max_ser_restore(struct v4l2_subdev *sd);
 
 int max_ser_reset(struct i2c_adapter *adapter, u8 addr);
+int max_ser_broadcast_reset(struct i2c_adapter *adapter, u8 addr);
 int max_ser_wait(struct i2c_adapter *adapter, u8 addr);
 int max_ser_wait_for_multiple(struct i2c_adapter *adapter, u8 *addrs,
 			      unsigned int num_addrs, u8 *current_addr);
@@ -4,11 +4,14 @@
  */
 
 #include <linux/export.h>
+#include <linux/i2c.h>
 #include <linux/kernel.h>
 #include <linux/module.h>
+#include <linux/property.h>
 #include <linux/stringify.h>
 
 #include <media/mipi-csi2.h>
+#include <media/v4l2-ctrls.h>
 
 #include <video/videomode.h>
 
@@ -35,6 +38,20 @@ const char *max_serdes_gmsl_version_str(enum max_serdes_gmsl_version version)
 	return max_gmsl_versions[version];
 }
 
+static const u64 max_gmsl_versions_bps[] = {
+	[MAX_SERDES_GMSL_2_3GBPS] = 3000000000ull,
+	[MAX_SERDES_GMSL_2_6GBPS] = 6000000000ull,
+	[MAX_SERDES_GMSL_3_12GBPS] = 12000000000ull,
+};
+
+u64 max_serdes_gmsl_version_bps(enum max_serdes_gmsl_version version)
+{
+	if (version > MAX_SERDES_GMSL_3_12GBPS)
+		return 0;
+
+	return max_gmsl_versions_bps[version];
+}
+
 static const char * const max_gmsl_mode[] = {
 	[MAX_SERDES_GMSL_PIXEL_MODE] = "pixel",
 	[MAX_SERDES_GMSL_TUNNEL_MODE] = "tunnel",
@@ -111,8 +128,157 @@ int max_serdes_get_fd_bpp(struct v4l2_mbus_frame_desc_entry *entry,
 	return 0;
 }
 
+#define MAX_SERDES_UPSTREAM_DEPTH	2
+
+static int __max_serdes_get_pixel_rate(struct media_entity *entity,
+				       u64 *pixel_rate, unsigned int depth)
+{
+	struct v4l2_subdev *sd;
+	struct v4l2_ctrl *ctrl;
+	unsigned int i;
+
+	if (!is_media_entity_v4l2_subdev(entity))
+		return -ENOENT;
+
+	sd = media_entity_to_v4l2_subdev(entity);
+
+	ctrl = v4l2_ctrl_find(sd->ctrl_handler, V4L2_CID_PIXEL_RATE);
+	if (ctrl) {
+		*pixel_rate = v4l2_ctrl_g_ctrl_int64(ctrl);
+		return 0;
+	}
+
+	if (!depth)
+		return -ENOENT;
+
+	for (i = 0; i < entity->num_pads; i++) {
+		struct media_pad *remote;
+
+		if (!(entity->pads[i].flags & MEDIA_PAD_FL_SINK))
+			continue;
+
+		remote = media_pad_remote_pad_first(&entity->pads[i]);
+		if (!remote)
+			continue;
+
+		if (!__max_serdes_get_pixel_rate(remote->entity, pixel_rate,
+						 depth - 1))
+			return 0;
+	}
+
+	return -ENOENT;
+}
+
+/*
+ * Find the pixel rate of the sensor feeding a subdev, walking upstream
+ * through the serializer if needed.
+ */
+int max_serdes_get_pixel_rate(struct v4l2_subdev *sd, u64 *pixel_rate)
+{
+	return __max_serdes_get_pixel_rate(&sd->entity, pixel_rate,
+					   MAX_SERDES_UPSTREAM_DEPTH);
+}
+
+static int __max_serdes_get_frame_interval(struct media_entity *entity,
+					   struct v4l2_fract *interval,
+					   unsigned int depth)
+{
+	unsigned int i;
+
+	for (i = 0; i < entity->num_pads; i++) {
+		struct v4l2_subdev_frame_interval fi = {
+			.which = V4L2_SUBDEV_FORMAT_ACTIVE,
+		};
+		struct media_pad *remote;
+		struct v4l2_subdev *sd;
+
+		if (!(entity->pads[i].flags & MEDIA_PAD_FL_SINK))
+			continue;
+
+		remote = media_pad_remote_pad_first(&entity->pads[i]);
+		if (!remote || !is_media_entity_v4l2_subdev(remote->entity))
+			continue;
+
+		sd = media_entity_to_v4l2_subdev(remote->entity);
+		fi.pad = remote->index;
+
+		if (!v4l2_subdev_call_state_active(sd, pad, get_frame_interval, &fi) &&
+		    fi.interval.numerator && fi.interval.denominator) {
+			*interval = fi.interval;
+			return 0;
+		}
+
+		if (depth && !__max_serdes_get_frame_interval(remote->entity,
+							      interval, depth - 1))
+			return 0;
+	}
+
+	return -ENOENT;
+}
+
+/*
+ * Find the frame interval of the sensor feeding a subdev, walking upstream
+ * through the serializer if needed.
+ */
+int max_serdes_get_frame_interval(struct v4l2_subdev *sd,
+				  struct v4l2_fract *interval)
+{
+	return __max_serdes_get_frame_interval(&sd->entity, interval,
+					       MAX_SERDES_UPSTREAM_DEPTH);
+}
+
+static u32 max_serdes_double_bpps(u32 bpps, unsigned int doubled_bpp)
+{
+	if (!doubled_bpp)
+		return bpps;
+
+	return (bpps & ~BIT(doubled_bpp)) | BIT(doubled_bpp * 2);
+}
+
+static bool max_serdes_bpps_valid(u32 bpps)
+{
+	unsigned int min_bpp = __ffs(bpps);
+	unsigned int max_bpp = __fls(bpps);
+
+	if (max_bpp > 24)
+		return false;
+
+	if (min_bpp <= 16 && max_bpp > 16)
+		return false;
+
+	if (max_bpp > 16 && min_bpp != max_bpp)
+		return false;
+
+	return true;
+}
+
+/*
+ * Bits sent over the link per second for the bpps, once all of them have
+ * been padded to the widest one, with rates holding the pixel rate of each
+ * bpp.
+ */
+static u64 max_serdes_bpps_cost(u32 bpps, unsigned int doubled_bpp,
+				const u64 *rates)
+{
+	unsigned int width = __fls(max_serdes_double_bpps(bpps, doubled_bpp));
+	unsigned long bpps_mask = bpps;
+	unsigned int bpp;
+	u64 cost = 0;
+
+	for_each_set_bit(bpp, &bpps_mask, MAX_SERDES_NUM_BPPS)
+		cost += rates[bpp] * (bpp == doubled_bpp ? width / 2 : width);
+
+	return cost;
+}
+
+/*
+ * Pick the bpp to double out of allowed_double_bpps. With rates, only double
+ * if that doesn't put more bits on the link. Without rates, the decision was
+ * already taken elsewhere and allowed_double_bpps is followed as is.
+ */
 int max_serdes_process_bpps(struct device *dev, u32 bpps,
-			    u32 allowed_double_bpps, unsigned int *doubled_bpp)
+			    u32 allowed_double_bpps, const u64 *rates,
+			    unsigned int *doubled_bpp)
 {
 	unsigned int min_bpp;
 	unsigned int max_bpp;
@@ -153,10 +319,18 @@ int max_serdes_process_bpps(struct device *dev, u32 bpps,
 			doubled = true;
 	}
 
-	if (doubled && (allowed_double_bpps & BIT(min_bpp))) {
+	/*
+	 * Doubling can make the other bpps be padded to a wider one, only do
+	 * it if that doesn't put more bits on the link than not doubling.
+	 * On a tie, doubling still halves the pipe's pixel clock.
+	 */
+	if (doubled && (allowed_double_bpps & BIT(min_bpp)) &&
+	    max_serdes_bpps_valid(max_serdes_double_bpps(bpps, min_bpp)) &&
+	    (!rates || !max_serdes_bpps_valid(bpps) ||
+	     max_serdes_bpps_cost(bpps, min_bpp, rates) <=
+	     max_serdes_bpps_cost(bpps, 0, rates))) {
 		*doubled_bpp = min_bpp;
-		bpps &= ~BIT(min_bpp);
-		bpps |= BIT(min_bpp * 2);
+		bpps = max_serdes_double_bpps(bpps, min_bpp);
 	}
 
 	min_bpp = __ffs(bpps);
@@ -289,6 +463,17 @@ int max_serdes_get_streams_masks(struct device *dev,
 	else
 		streams_masks[pad] &= ~updated_streams_mask;
 
+	/* Sink streams replicated to other source streams may still be in use. */
+	if (!enable) {
+		struct v4l2_subdev_route *route;
+
+		for_each_active_route(&state->routing, route)
+			if (streams_masks[route->source_pad] &
+			    BIT_ULL(route->source_stream))
+				streams_masks[route->sink_pad] |=
+					BIT_ULL(route->sink_stream);
+	}
+
 	*new_streams_masks = streams_masks;
 
 	return 0;
@@ -328,6 +513,29 @@ static const struct videomode max_serdes_tpg_pixel_videomodes[] = {
 		.vsync_len = 16,
 		.vback_porch = 36,
 	},
+	/* Extended blanking to get integer frame rates out of 375MHz. */
+	{
+		.pixelclock = 375000000,
+		.hactive = 1920,
+		.hfront_porch = 88,
+		.hsync_len = 44,
+		.hback_porch = 448,
+		.vactive = 1080,
+		.vfront_porch = 4,
+		.vsync_len = 16,
+		.vback_porch = 150,
+	},
+	{
+		.pixelclock = 375000000,
+		.hactive = 3840,
+		.hfront_porch = 48,
+		.hsync_len = 32,
+		.hback_porch = 80,
+		.vactive = 2160,
+		.vfront_porch = 8,
+		.vsync_len = 10,
+		.vback_porch = 947,
+	},
 };
 
 static void max_serdes_get_vm_timings(const struct videomode *vm,
@@ -397,22 +605,37 @@ int max_serdes_get_tpg_timings(const struct max_serdes_tpg_entry *entry,
 }
 EXPORT_SYMBOL_NS_GPL(max_serdes_get_tpg_timings, "MAX_SERDES");
 
-int max_serdes_validate_tpg_routing(struct v4l2_subdev_krouting *routing)
+/*
+ * The TPG can be replicated into up to num_streams streams, all sharing the
+ * format of MAX_SERDES_TPG_STREAM, but cannot be mixed with other sources.
+ */
+int max_serdes_validate_tpg_routing(struct v4l2_subdev_krouting *routing,
+				    unsigned int num_streams)
 {
 	const struct v4l2_subdev_route *route;
+	bool has_tpg_stream = false;
+	unsigned int i;
 
-	if (routing->num_routes != 1)
+	if (!routing->num_routes || routing->num_routes > num_streams)
 		return -EINVAL;
 
-	route = &routing->routes[0];
+	for (i = 0; i < routing->num_routes; i++) {
+		route = &routing->routes[i];
 
-	if (!(route->flags & V4L2_SUBDEV_ROUTE_FL_ACTIVE))
-		return -EINVAL;
+		if (!(route->flags & V4L2_SUBDEV_ROUTE_FL_ACTIVE))
+			return -EINVAL;
 
-	if (route->sink_stream != MAX_SERDES_TPG_STREAM)
-		return -EINVAL;
+		if (route->sink_pad != routing->routes[0].sink_pad)
+			return -EINVAL;
 
-	return 0;
+		if (route->sink_stream >= num_streams)
+			return -EINVAL;
+
+		if (route->sink_stream == MAX_SERDES_TPG_STREAM)
+			has_tpg_stream = true;
+	}
+
+	return has_tpg_stream ? 0 : -EINVAL;
 }
 
 int max_serdes_get_fwnode_pad_1_to_1(struct media_entity *entity,
@@ -439,6 +662,67 @@ int max_serdes_get_fwnode_pad_1_to_1(struct media_entity *entity,
 }
 EXPORT_SYMBOL_NS_GPL(max_serdes_get_fwnode_pad_1_to_1, "MAX_SERDES");
 
+struct max_serdes_swnode_bus {
+	struct fwnode_handle *fwnode;
+	struct i2c_adapter *adapter;
+};
+
+static int max_serdes_match_swnode_bus(struct device *dev, void *data)
+{
+	struct max_serdes_swnode_bus *bus = data;
+	struct i2c_adapter *adapter = i2c_verify_adapter(dev);
+
+	if (!adapter || !device_match_fwnode(dev, bus->fwnode))
+		return 0;
+
+	bus->adapter = adapter;
+
+	return 1;
+}
+
+/*
+ * The I2C core only enumerates DT and ACPI described devices on new adapters.
+ * Platform glue which describes the remote devices using software nodes
+ * relies on us to instantiate them, using the same "compatible" and "reg"
+ * properties as the DT bindings. The clients are unregistered together with
+ * the adapter.
+ */
+void max_serdes_register_swnode_clients(struct device *dev,
+					struct fwnode_handle *fwnode)
+{
+	struct max_serdes_swnode_bus bus = { .fwnode = fwnode };
+	struct fwnode_handle *child;
+
+	if (!is_software_node(fwnode))
+		return;
+
+	if (!device_for_each_child(dev, &bus, max_serdes_match_swnode_bus))
+		return;
+
+	fwnode_for_each_child_node(fwnode, child) {
+		struct i2c_board_info info = { 0 };
+		struct i2c_client *client;
+		const char *compatible;
+		const char *type;
+		u32 reg;
+
+		if (fwnode_property_read_string(child, "compatible", &compatible) ||
+		    fwnode_property_read_u32(child, "reg", &reg))
+			continue;
+
+		type = strchr(compatible, ',');
+		strscpy(info.type, type ? type + 1 : compatible, sizeof(info.type));
+		info.addr = reg;
+		info.swnode = to_software_node(child);
+
+		client = i2c_new_client_device(bus.adapter, &info);
+		if (IS_ERR(client))
+			dev_err(dev, "Failed to register %s at 0x%02x: %pe\n",
+				info.type, info.addr, client);
+	}
+}
+EXPORT_SYMBOL_NS_GPL(max_serdes_register_swnode_clients, "MAX_SERDES");
+
 MODULE_DESCRIPTION("Maxim GMSL2 Serializer/Deserializer Driver");
 MODULE_AUTHOR("Cosmin Tanislav <cosmin.tanislav@analog.com>");
 MODULE_LICENSE("GPL");
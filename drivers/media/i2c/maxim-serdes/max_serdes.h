@@ -31,7 +31,20 @@
 #define MAX_SERDES_PHYS_MAX		4
 #define MAX_SERDES_STREAMS_NUM		4
 #define MAX_SERDES_VC_ID_NUM		4
+#define MAX_SERDES_VCX_ID_NUM_DPHY	16
+#define MAX_SERDES_VCX_ID_NUM_CPHY	32
 #define MAX_SERDES_TPG_STREAM		0
+#define MAX_SERDES_NUM_BPPS		32
+
+/*
+ * Sent on a link's sink pad when the link loses or regains lock, with
+ * u.data[0] set to whether the link is locked.
+ */
+#define MAX_SERDES_EVENT_LINK_LOCK	(V4L2_EVENT_PRIVATE_START + 0x1)
+
+#define MAX_SERDES_CID_FSYNC_MODE	(V4L2_CID_USER_BASE | 0x1200)
+#define MAX_SERDES_CID_FSYNC_PERIOD	(V4L2_CID_USER_BASE | 0x1201)
+#define MAX_SERDES_CID_GROUPED_START	(V4L2_CID_USER_BASE | 0x1202)
 
 #define MAX_SERDES_GRAD_INCR		4
 #define MAX_SERDES_CHECKER_COLOR_A	0x00ccfe
@@ -117,6 +130,12 @@ struct max_serdes_tpg_entry {
 #define MAX_TPG_ENTRY_1920X1080P60_RGB888 \
 	{ 1920, 1080, { 1, 60 }, MEDIA_BUS_FMT_RGB888_1X24, MIPI_CSI2_DT_RGB888, 24 }
 
+#define MAX_TPG_ENTRY_1920X1080P120_RGB888 \
+	{ 1920, 1080, { 1, 120 }, MEDIA_BUS_FMT_RGB888_1X24, MIPI_CSI2_DT_RGB888, 24 }
+
+#define MAX_TPG_ENTRY_3840X2160P30_RGB888 \
+	{ 3840, 2160, { 1, 30 }, MEDIA_BUS_FMT_RGB888_1X24, MIPI_CSI2_DT_RGB888, 24 }
+
 struct max_serdes_tpg_entries {
 	const struct max_serdes_tpg_entry *entries;
 	unsigned int num_entries;
@@ -150,6 +169,7 @@ static inline struct max_serdes_asc *asc_to_max(struct v4l2_async_connection *as
 }
 
 const char *max_serdes_gmsl_version_str(enum max_serdes_gmsl_version version);
+u64 max_serdes_gmsl_version_bps(enum max_serdes_gmsl_version version);
 const char *max_serdes_gmsl_mode_str(enum max_serdes_gmsl_mode mode);
 
 const struct max_serdes_mipi_format *max_serdes_mipi_format_by_dt(u8 dt);
@@ -159,8 +179,12 @@ int max_serdes_get_fd_stream_entry(struct v4l2_subdev *sd, u32 pad, u32 stream,
 
 int max_serdes_get_fd_bpp(struct v4l2_mbus_frame_desc_entry *entry,
 			  unsigned int *bpp);
+int max_serdes_get_pixel_rate(struct v4l2_subdev *sd, u64 *pixel_rate);
+int max_serdes_get_frame_interval(struct v4l2_subdev *sd,
+				  struct v4l2_fract *interval);
 int max_serdes_process_bpps(struct device *dev, u32 bpps,
-			    u32 allowed_double_bpps, unsigned int *doubled_bpp);
+			    u32 allowed_double_bpps, const u64 *rates,
+			    unsigned int *doubled_bpp);
 
 int max_serdes_xlate_enable_disable_streams(struct max_serdes_source *sources,
 					    u32 source_sink_pad_offset,
@@ -178,7 +202,11 @@ int max_serdes_get_streams_masks(struct device *dev,
 int max_serdes_get_tpg_timings(const struct max_serdes_tpg_entry *entry,
 			       struct max_serdes_tpg_timings *timings);
 
-int max_serdes_validate_tpg_routing(struct v4l2_subdev_krouting *routing);
+int max_serdes_validate_tpg_routing(struct v4l2_subdev_krouting *routing,
+				    unsigned int num_streams);
 int max_serdes_get_fwnode_pad_1_to_1(struct media_entity *entity,
 				      struct fwnode_endpoint *endpoint);
+
+void max_serdes_register_swnode_clients(struct device *dev,
+					struct fwnode_handle *fwnode);
 #endif // MAX_SERDES_H
@@ -12,8 +12,12 @@
  * GNU General Public License for more details.
  *
  */
+#include <linux/list.h>
+#include <linux/property.h>
+
 #include <media/ipu-acpi.h>
 #include <media/ipu-acpi-pdata.h>
+#include <media/v4l2-fwnode.h>
 
 #define MIN_SENSOR_I2C 1
 #define MIN_SERDES_I2C 3
@@ -739,6 +743,265 @@ static int set_pdata(struct ipu_isys_subdev_info **sensor_sd,
 	return 0;
 }
 
+/*
+ * maxim-serdes does not consume serdes_platform_data, it expects the same
+ * description as its DT bindings. Build it as a software node graph of the
+ * deserializer, with a serializer and a sensor behind each of its links.
+ */
+#define SERDES_DES_NUM_LINKS	4
+#define SERDES_MAX_LANES	4
+#define SERDES_SWNODE_NAME_LEN	16
+
+enum serdes_link_swnode_ids {
+	SWNODE_DES_LINK_PORT,
+	SWNODE_DES_LINK_EP,
+	SWNODE_DES_I2C,
+	SWNODE_SER,
+	SWNODE_SER_SINK_PORT,
+	SWNODE_SER_SINK_EP,
+	SWNODE_SER_LINK_PORT,
+	SWNODE_SER_LINK_EP,
+	SWNODE_SENSOR,
+	SWNODE_SENSOR_PORT,
+	SWNODE_SENSOR_EP,
+	SWNODE_LINK_NUM
+};
+
+struct serdes_link_swnodes {
+	char des_port_name[SERDES_SWNODE_NAME_LEN];
+	char des_i2c_name[SERDES_SWNODE_NAME_LEN];
+	char gpio_names[MAX_SER_GPIO_NUM][I2C_NAME_SIZE];
+	struct software_node nodes[SWNODE_LINK_NUM];
+	struct software_node_ref_args des_ep_remote[1];
+	struct software_node_ref_args ser_sink_ep_remote[1];
+	struct software_node_ref_args ser_link_ep_remote[1];
+	struct software_node_ref_args sensor_ep_remote[1];
+	struct software_node_ref_args sensor_gpios[MAX_SER_GPIO_NUM];
+	struct property_entry des_ep_props[2];
+	struct property_entry des_i2c_props[2];
+	struct property_entry ser_props[4];
+	struct property_entry ser_sink_ep_props[3];
+	struct property_entry ser_link_ep_props[2];
+	struct property_entry sensor_props[MAX_SER_GPIO_NUM + 3];
+	struct property_entry sensor_ep_props[3];
+	u16 sensor_alias;
+};
+
+struct serdes_swnodes {
+	struct list_head list;
+	char des_name[I2C_NAME_SIZE];
+	char des_phy_port_name[SERDES_SWNODE_NAME_LEN];
+	struct software_node des;
+	struct software_node des_phy_port;
+	struct software_node des_phy_ep;
+	struct property_entry des_props[2];
+	struct property_entry des_phy_ep_props[4];
+	u16 ser_aliases[SERDES_DES_NUM_LINKS];
+	u32 des_lanes[SERDES_MAX_LANES];
+	u32 ser_lanes[SERDES_MAX_LANES];
+	u64 link_freq;
+	struct serdes_link_swnodes links[SERDES_DES_NUM_LINKS];
+	const struct software_node *group[3 + SWNODE_LINK_NUM * SERDES_DES_NUM_LINKS + 1];
+};
+
+/* Registered node groups, released when ipu-acpi is unloaded. */
+static LIST_HEAD(serdes_swnodes_list);
+
+static void set_serdes_link_swnodes(struct serdes_swnodes *swnodes,
+				    struct serdes_subdev_info *sdinfo,
+				    unsigned int ser_nlanes,
+				    unsigned int index)
+{
+	struct serdes_link_swnodes *link = &swnodes->links[index];
+	struct software_node *nodes = link->nodes;
+	unsigned int i, n = 0;
+
+	snprintf(link->des_port_name, sizeof(link->des_port_name),
+		 SWNODE_GRAPH_PORT_NAME_FMT, index);
+	snprintf(link->des_i2c_name, sizeof(link->des_i2c_name), "i2c@%u", index);
+
+	nodes[SWNODE_DES_LINK_PORT] = SOFTWARE_NODE(link->des_port_name, NULL,
+						    &swnodes->des);
+	nodes[SWNODE_DES_LINK_EP] = SOFTWARE_NODE("endpoint@0", link->des_ep_props,
+						  &nodes[SWNODE_DES_LINK_PORT]);
+	nodes[SWNODE_DES_I2C] = SOFTWARE_NODE(link->des_i2c_name, link->des_i2c_props,
+					      &swnodes->des);
+	nodes[SWNODE_SER] = SOFTWARE_NODE("serializer", link->ser_props,
+					  &nodes[SWNODE_DES_I2C]);
+	nodes[SWNODE_SER_SINK_PORT] = SOFTWARE_NODE("port@0", NULL, &nodes[SWNODE_SER]);
+	nodes[SWNODE_SER_SINK_EP] = SOFTWARE_NODE("endpoint@0", link->ser_sink_ep_props,
+						  &nodes[SWNODE_SER_SINK_PORT]);
+	nodes[SWNODE_SER_LINK_PORT] = SOFTWARE_NODE("port@1", NULL, &nodes[SWNODE_SER]);
+	nodes[SWNODE_SER_LINK_EP] = SOFTWARE_NODE("endpoint@0", link->ser_link_ep_props,
+						  &nodes[SWNODE_SER_LINK_PORT]);
+	nodes[SWNODE_SENSOR] = SOFTWARE_NODE("sensor", link->sensor_props,
+					     &nodes[SWNODE_SER]);
+	nodes[SWNODE_SENSOR_PORT] = SOFTWARE_NODE("port@0", NULL, &nodes[SWNODE_SENSOR]);
+	nodes[SWNODE_SENSOR_EP] = SOFTWARE_NODE("endpoint@0", link->sensor_ep_props,
+						&nodes[SWNODE_SENSOR_PORT]);
+
+	link->des_ep_remote[0] = SOFTWARE_NODE_REFERENCE(&nodes[SWNODE_SER_LINK_EP]);
+	link->ser_link_ep_remote[0] = SOFTWARE_NODE_REFERENCE(&nodes[SWNODE_DES_LINK_EP]);
+	link->ser_sink_ep_remote[0] = SOFTWARE_NODE_REFERENCE(&nodes[SWNODE_SENSOR_EP]);
+	link->sensor_ep_remote[0] = SOFTWARE_NODE_REFERENCE(&nodes[SWNODE_SER_SINK_EP]);
+
+	link->des_ep_props[0] = PROPERTY_ENTRY_REF_ARRAY("remote-endpoint",
+							 link->des_ep_remote);
+	link->des_i2c_props[0] = PROPERTY_ENTRY_U32("reg", index);
+
+	/* The ATR of each serializer maps its sensor to the ACPI mapped address */
+	link->sensor_alias = sdinfo->board_info.addr;
+	link->ser_props[0] = PROPERTY_ENTRY_STRING("compatible",
+						   MAXIM_SERDES_SER_COMPATIBLE);
+	link->ser_props[1] = PROPERTY_ENTRY_U32("reg", sdinfo->ser_phys_addr);
+	link->ser_props[2] = PROPERTY_ENTRY_U16_ARRAY_LEN("i2c-alias-pool",
+							  &link->sensor_alias, 1);
+	link->ser_sink_ep_props[0] = PROPERTY_ENTRY_U32_ARRAY_LEN("data-lanes",
+								  swnodes->ser_lanes,
+								  ser_nlanes);
+	link->ser_sink_ep_props[1] = PROPERTY_ENTRY_REF_ARRAY("remote-endpoint",
+							      link->ser_sink_ep_remote);
+	link->ser_link_ep_props[0] = PROPERTY_ENTRY_REF_ARRAY("remote-endpoint",
+							      link->ser_link_ep_remote);
+
+	link->sensor_props[n++] = PROPERTY_ENTRY_STRING("compatible",
+							sdinfo->board_info.type);
+	link->sensor_props[n++] = PROPERTY_ENTRY_U32("reg", sdinfo->phy_i2c_addr);
+
+	/* Sensor GPIOs are lines of the serializer GPIO chip */
+	for (i = 0; i < MAX_SER_GPIO_NUM; i++) {
+		struct gpiod_lookup *gpio = &sdinfo->ser_gpio[i];
+
+		if (!gpio->con_id)
+			continue;
+
+		snprintf(link->gpio_names[i], sizeof(link->gpio_names[i]),
+			 "%s-gpios", gpio->con_id);
+		link->sensor_gpios[i] = SOFTWARE_NODE_REFERENCE(&nodes[SWNODE_SER],
+								gpio->chip_hwnum,
+								gpio->flags);
+		link->sensor_props[n++] = PROPERTY_ENTRY_REF_ARRAY_LEN(link->gpio_names[i],
+								       &link->sensor_gpios[i], 1);
+	}
+
+	link->sensor_ep_props[0] = PROPERTY_ENTRY_U32_ARRAY_LEN("data-lanes",
+								swnodes->ser_lanes,
+								ser_nlanes);
+	link->sensor_ep_props[1] = PROPERTY_ENTRY_REF_ARRAY("remote-endpoint",
+							    link->sensor_ep_remote);
+}
+
+static int set_serdes_swnodes(struct device *dev,
+			      struct ipu_isys_subdev_info *serdes_sd)
+{
+	struct serdes_platform_data *pdata = serdes_sd->i2c.board_info.platform_data;
+	unsigned int csi_port = pdata->des_port / 90;
+	const struct software_node *registered;
+	struct serdes_swnodes *swnodes;
+	unsigned int phy, i, j, n = 0;
+	int ret;
+
+	if (pdata->subdev_num > SERDES_DES_NUM_LINKS ||
+	    pdata->deser_nlanes > SERDES_MAX_LANES ||
+	    pdata->ser_nlanes > SERDES_MAX_LANES) {
+		dev_err(dev, "IPU ACPI: Invalid serdes config: %u links, %u/%u lanes\n",
+			pdata->subdev_num, pdata->deser_nlanes, pdata->ser_nlanes);
+		return -EINVAL;
+	}
+
+	swnodes = kzalloc(sizeof(*swnodes), GFP_KERNEL);
+	if (!swnodes)
+		return -ENOMEM;
+
+	snprintf(swnodes->des_name, sizeof(swnodes->des_name), "%s-%c",
+		 MAXIM_SERDES_DES_NAME, pdata->suffix);
+
+	/* Already described by a previous scan of the ACPI devices. */
+	registered = software_node_find_by_name(NULL, swnodes->des_name);
+	if (registered) {
+		/* The node stays registered until release_serdes_swnodes(). */
+		fwnode_handle_put(software_node_fwnode(registered));
+		serdes_sd->i2c.board_info.swnode = registered;
+		kfree(swnodes);
+		return 0;
+	}
+
+	/*
+	 * max9x drives a 4 lane port 1 from PHY1 using the data lanes of PHY0,
+	 * which maxim-serdes describes as a 4 lane PHY0.
+	 */
+	phy = (csi_port == 1 && pdata->deser_nlanes == 4) ? 0 : csi_port;
+
+	for (i = 0; i < pdata->deser_nlanes; i++)
+		swnodes->des_lanes[i] = i + 1;
+
+	for (i = 0; i < pdata->ser_nlanes; i++)
+		swnodes->ser_lanes[i] = i + 1;
+
+	for (i = 0; i < pdata->subdev_num; i++)
+		swnodes->ser_aliases[i] = pdata->subdev_info[i].ser_alias;
+
+	/* link_freq_mbps is the per lane bit rate, on both clock edges */
+	swnodes->link_freq = pdata->link_freq_mbps * 1000000ULL / 2;
+
+	swnodes->des = SOFTWARE_NODE(swnodes->des_name, swnodes->des_props, NULL);
+	swnodes->des_props[0] = PROPERTY_ENTRY_U16_ARRAY_LEN("i2c-alias-pool",
+							     swnodes->ser_aliases,
+							     pdata->subdev_num);
+
+	snprintf(swnodes->des_phy_port_name, sizeof(swnodes->des_phy_port_name),
+		 SWNODE_GRAPH_PORT_NAME_FMT, SERDES_DES_NUM_LINKS + phy);
+	swnodes->des_phy_port = SOFTWARE_NODE(swnodes->des_phy_port_name, NULL,
+					      &swnodes->des);
+	swnodes->des_phy_ep = SOFTWARE_NODE("endpoint@0", swnodes->des_phy_ep_props,
+					    &swnodes->des_phy_port);
+	swnodes->des_phy_ep_props[0] =
+		PROPERTY_ENTRY_U32("bus-type", pdata->bus_type == V4L2_MBUS_CSI2_CPHY ?
+				   V4L2_FWNODE_BUS_TYPE_CSI2_CPHY :
+				   V4L2_FWNODE_BUS_TYPE_CSI2_DPHY);
+	swnodes->des_phy_ep_props[1] = PROPERTY_ENTRY_U32_ARRAY_LEN("data-lanes",
+								    swnodes->des_lanes,
+								    pdata->deser_nlanes);
+	swnodes->des_phy_ep_props[2] = PROPERTY_ENTRY_U64_ARRAY_LEN("link-frequencies",
+								    &swnodes->link_freq, 1);
+
+	swnodes->group[n++] = &swnodes->des;
+	swnodes->group[n++] = &swnodes->des_phy_port;
+	swnodes->group[n++] = &swnodes->des_phy_ep;
+
+	for (i = 0; i < pdata->subdev_num; i++) {
+		set_serdes_link_swnodes(swnodes, &pdata->subdev_info[i],
+					pdata->ser_nlanes, i);
+
+		for (j = 0; j < SWNODE_LINK_NUM; j++)
+			swnodes->group[n++] = &swnodes->links[i].nodes[j];
+	}
+
+	ret = software_node_register_node_group(swnodes->group);
+	if (ret) {
+		dev_err(dev, "IPU ACPI: Failed to register %s swnodes: %d\n",
+			swnodes->des_name, ret);
+		kfree(swnodes);
+		return ret;
+	}
+
+	list_add_tail(&swnodes->list, &serdes_swnodes_list);
+	serdes_sd->i2c.board_info.swnode = &swnodes->des;
+
+	return 0;
+}
+
+void release_serdes_swnodes(void)
+{
+	struct serdes_swnodes *swnodes, *tmp;
+
+	list_for_each_entry_safe(swnodes, tmp, &serdes_swnodes_list, list) {
+		list_del(&swnodes->list);
+		software_node_unregister_node_group(swnodes->group);
+		kfree(swnodes);
+	}
+}
+
 static void set_serdes_info(struct device *dev, const char *sensor_name,
 			    const char *serdes_name,
 			    struct sensor_bios_data *cam_data,
@@ -854,6 +1117,12 @@ static int populate_sensor_pdata(struct device *dev,
 	if (ret)
 		return ret;
 
+	if (connect == TYPE_SERDES && !strcmp(serdes_name, MAXIM_SERDES_DES_NAME)) {
+		ret = set_serdes_swnodes(dev, *sensor_sd);
+		if (ret)
+			return ret;
+	}
+
 	update_pdata(dev, *sensor_sd, connect);
 
 	/* Lontium specific */
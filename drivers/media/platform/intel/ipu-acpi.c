@@ -55,6 +55,15 @@
 
 static LIST_HEAD(devices);
 
+/*
+ * GMSL modules flagged with maxim_serdes can be bound either through max9x or
+ * through the ATR based maxim-serdes drivers, which address the remote devices
+ * of all the links concurrently instead of selecting one link at a time.
+ */
+static bool maxim_serdes = !IS_ENABLED(CONFIG_VIDEO_MAX9X);
+module_param(maxim_serdes, bool, 0444);
+MODULE_PARM_DESC(maxim_serdes, "Bind GMSL cameras through maxim-serdes instead of max9x");
+
 static struct ipu_camera_module_data *add_device_to_list(
 	struct list_head *devices)
 {
@@ -74,7 +83,7 @@ static const struct ipu_acpi_devices supported_devices[] = {
  *		sensor_physical_addr, link_freq(mbps), ser_physical_addr },	// Custom HID
  */
 
-#if IS_ENABLED(CONFIG_VIDEO_MAX9X)
+#if IS_ENABLED(CONFIG_VIDEO_MAX9X) || IS_ENABLED(CONFIG_VIDEO_MAX96724)
 #if IS_ENABLED(CONFIG_VIDEO_ISX031)
 	{ 
 		.hid_name = "INTC031M",
@@ -84,6 +93,7 @@ static const struct ipu_acpi_devices supported_devices[] = {
 		.priv_size = 0,
 		.connect = TYPE_SERDES,
 		.serdes_name = "max9x",
+		.maxim_serdes = true,
 		.sensor_physical_addr = ISX031_I2C_ADDRESS,
 		.link_freq = 1600,
 		.ser_physical_addr = 0x40,
@@ -104,6 +114,7 @@ static const struct ipu_acpi_devices supported_devices[] = {
 		.priv_size = 0,
 		.connect = TYPE_SERDES,
 		.serdes_name = "max9x",
+		.maxim_serdes = true,
 		.sensor_physical_addr = ISX031_I2C_ADDRESS,
 		.link_freq = 1600,
 		.ser_physical_addr = 0x62,
@@ -124,6 +135,7 @@ static const struct ipu_acpi_devices supported_devices[] = {
 		.priv_size = 0,
 		.connect = TYPE_SERDES,
 		.serdes_name = "max9x",
+		.maxim_serdes = true,
 		.sensor_physical_addr = ISX031_I2C_ADDRESS,
 		.link_freq = 1600,
 		.ser_physical_addr = 0x40,
@@ -149,6 +161,7 @@ static const struct ipu_acpi_devices supported_devices[] = {
 		.priv_size = 0,
 		.connect = TYPE_SERDES,
 		.serdes_name = "max9x",
+		.maxim_serdes = true,
 		.sensor_physical_addr = ISX031_I2C_ADDRESS,
 		.link_freq = 1600,
 		.ser_physical_addr = 0x62,
@@ -176,6 +189,7 @@ static const struct ipu_acpi_devices supported_devices[] = {
 		.priv_size = 0,
 		.connect = TYPE_SERDES,
 		.serdes_name = "max9x",
+		.maxim_serdes = true,
 		.sensor_physical_addr = AR0820_I2C_ADDRESS,
 		.link_freq = 1600,
 		.ser_physical_addr = 0x40,
@@ -203,6 +217,7 @@ static const struct ipu_acpi_devices supported_devices[] = {
 		.priv_size = 0,
 		.connect = TYPE_SERDES,
 		.serdes_name = "max9x",
+		.maxim_serdes = true,
 		.sensor_physical_addr = AR0233_I2C_ADDRESS,
 		.link_freq = 1600,
 		.ser_physical_addr = 0x40,
@@ -221,7 +236,7 @@ static const struct ipu_acpi_devices supported_devices[] = {
 		.sensor_dt = MIPI_CSI2_TYPE_YUV422_8,
 	  },  // AR0233 HID
 #endif
-#if IS_ENABLED(CONFIG_VIDEO_AR0234)
+#if IS_ENABLED(CONFIG_VIDEO_MAX9X) && IS_ENABLED(CONFIG_VIDEO_AR0234)
 	{ 
 		.hid_name = "INTC0234",
 		.real_driver = AR0234_NAME,
@@ -281,6 +296,15 @@ static const struct acpi_device_id ipu_acpi_match[] = {
 	{},
 };
 
+static const char *ipu_acpi_serdes_name(const struct ipu_acpi_devices *device)
+{
+	if (IS_ENABLED(CONFIG_VIDEO_MAX96724) && maxim_serdes &&
+	    device->maxim_serdes)
+		return MAXIM_SERDES_DES_NAME;
+
+	return device->serdes_name;
+}
+
 static int ipu_acpi_get_pdata(struct device *dev, int index)
 {
 	struct ipu_camera_module_data *camdata;
@@ -304,7 +328,7 @@ static int ipu_acpi_get_pdata(struct device *dev, int index)
 		supported_devices[index].priv_size,
 		supported_devices[index].connect,
 		supported_devices[index].real_driver,
-		supported_devices[index].serdes_name,
+		ipu_acpi_serdes_name(&supported_devices[index]),
 		supported_devices[index].hid_name,
 		supported_devices[index].sensor_physical_addr,
 		supported_devices[index].link_freq,
@@ -447,6 +471,8 @@ static void __exit ipu_acpi_exit(void)
 		list_del(&cam_device->list);
 		kfree(cam_device);
 	}
+
+	release_serdes_swnodes();
 }
 
 module_init(ipu_acpi_init);
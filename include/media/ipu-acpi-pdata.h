@@ -34,6 +34,8 @@ int get_sensor_pdata(struct device *dev,
 
 struct ipu_isys_subdev_pdata *get_acpi_subdev_pdata(void);
 
+void release_serdes_swnodes(void);
+
 struct sensor_platform_data {
 	unsigned int port;
 	unsigned int lanes;
@@ -75,6 +75,10 @@ struct ipu_isys_subdev_pdata {
 #define MIPI_CSI2_TYPE_YUV422_8 0x1e
 #define MIPI_CSI2_TYPE_RAW10 	0x2b
 
+/* Deserializer and serializer bound through the ATR based maxim-serdes stack */
+#define MAXIM_SERDES_DES_NAME		"max96724"
+#define MAXIM_SERDES_SER_COMPATIBLE	"maxim,max9295a"
+
 void set_built_in_pdata(struct ipu_isys_subdev_pdata *pdata);
 
 enum connection_type {
@@ -247,6 +251,7 @@ struct ipu_acpi_devices {
 	size_t priv_size;
 	enum connection_type connect;
 	const char *serdes_name;
+	bool maxim_serdes; /* can also be bound through maxim-serdes */
 	int sensor_physical_addr;
 	int link_freq; /* in mbps */
 	int ser_physical_addr;